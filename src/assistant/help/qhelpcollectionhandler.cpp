@@ -54,9 +54,19 @@ private:
     bool m_inTransaction;
 };
 
+// Pages of a documentation set refer to each other, and to common style
+// sheets and images, so keeping a few of them and their readers at hand
+// saves opening the file and decompressing on most loads.
+enum {
+    MaxCachedReaders = 8,
+    MaxCachedFileDataSize = 16 * 1024 * 1024
+};
+
 QHelpCollectionHandler::QHelpCollectionHandler(const QString &collectionFile, QObject *parent)
     : QObject(parent)
     , m_collectionFile(collectionFile)
+    , m_readerCache(MaxCachedReaders)
+    , m_fileDataCache(MaxCachedFileDataSize)
 {
     const QFileInfo fi(m_collectionFile);
     if (!fi.isAbsolute())
@@ -77,8 +87,15 @@ bool QHelpCollectionHandler::isDBOpened() const
     return false;
 }
 
+void QHelpCollectionHandler::clearFileDataCache()
+{
+    m_fileDataCache.clear();
+    m_readerCache.clear();
+}
+
 void QHelpCollectionHandler::closeDB()
 {
+    clearFileDataCache();
     if (!m_query)
         return;
 
@@ -862,6 +879,8 @@ bool QHelpCollectionHandler::registerDocumentation(const QString &fileName)
     if (!isDBOpened())
         return false;
 
+    clearFileDataCache();
+
     QHelpDBReader reader(fileName, QHelpGlobal::uniquifyConnectionName(
         QLatin1String("QHelpCollectionHandler"), this), nullptr);
     if (!reader.init()) {
@@ -899,6 +918,8 @@ bool QHelpCollectionHandler::unregisterDocumentation(const QString &namespaceNam
     if (!isDBOpened())
         return false;
 
+    clearFileDataCache();
+
     m_query->prepare(QLatin1String("SELECT Id FROM NamespaceTable WHERE Name = ?"));
     m_query->bindValue(0, namespaceName);
     m_query->exec();
@@ -1357,16 +1378,30 @@ QByteArray QHelpCollectionHandler::fileData(const QUrl &url) const
         return QByteArray();
 
     const FileInfo fileInfo = extractFileInfo(url);
+    const QString key = namespaceName + QLatin1Char('/') + fileInfo.folderName
+            + QLatin1Char('/') + fileInfo.fileName;
+    if (const QByteArray *data = m_fileDataCache.object(key))
+        return *data;
+
+    QHelpDBReader *reader = m_readerCache.object(namespaceName);
+    if (!reader) {
+        const FileInfo docInfo = registeredDocumentation(namespaceName);
+        const QString absFileName = absoluteDocPath(docInfo.fileName);
+
+        reader = new QHelpDBReader(absFileName, QHelpGlobal::uniquifyConnectionName(
+                                       docInfo.fileName, const_cast<QHelpCollectionHandler *>(this)),
+                                   nullptr);
+        if (!reader->init()) {
+            delete reader;
+            return QByteArray();
+        }
+        m_readerCache.insert(namespaceName, reader);
+    }
 
-    const FileInfo docInfo = registeredDocumentation(namespaceName);
-    const QString absFileName = absoluteDocPath(docInfo.fileName);
-
-    QHelpDBReader reader(absFileName, QHelpGlobal::uniquifyConnectionName(
-                             docInfo.fileName, const_cast<QHelpCollectionHandler *>(this)), nullptr);
-    if (!reader.init())
-        return QByteArray();
-
-    return reader.fileData(fileInfo.folderName, fileInfo.fileName);
+    const QByteArray data = reader->fileData(fileInfo.folderName, fileInfo.fileName);
+    if (!data.isEmpty())
+        m_fileDataCache.insert(key, new QByteArray(data), data.size());
+    return data;
 }
 
 QStringList QHelpCollectionHandler::indicesForFilter(const QStringList &filterAttributes) const
@@ -15,6 +15,7 @@
 // We mean it.
 //
 
+#include <QtCore/QCache>
 #include <QtCore/QList>
 #include <QtCore/QString>
 #include <QtCore/QObject>
@@ -216,12 +217,18 @@ private:
     bool hasTimeStampInfo(const QString &nameSpace) const;
     void scheduleVacuum();
     void execVacuum();
+    void clearFileDataCache();
 
     QString m_collectionFile;
     QString m_connectionName;
     QSqlQuery *m_query = nullptr;
     bool m_vacuumScheduled = false;
     bool m_readOnly = true;
+
+    // Readers of the documentation files recently read from, by namespace,
+    // and the files recently read, uncompressed, by namespace and path.
+    mutable QCache<QString, QHelpDBReader> m_readerCache;
+    mutable QCache<QString, QByteArray> m_fileDataCache;
 };
 
 QT_END_NAMESPACE
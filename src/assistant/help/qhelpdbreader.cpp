@@ -6,7 +6,6 @@
 
 #include <QtCore/QFile>
 #include <QtCore/QList>
-#include <QtCore/QMultiMap>
 #include <QtCore/QVariant>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
@@ -32,6 +31,7 @@ QHelpDBReader::QHelpDBReader(const QString &dbName, const QString &uniqueId,
 QHelpDBReader::~QHelpDBReader()
 {
     if (m_initDone) {
+        delete m_fileDataQuery;
         delete m_query;
         QSqlDatabase::removeDatabase(m_uniqueId);
     }
@@ -385,27 +385,32 @@ QByteArray QHelpDBReader::fileData(const QString &virtualFolder,
         return ba;
 
     namespaceName();
-    m_query->prepare(QLatin1String(
-                    "SELECT "
-                        "FileDataTable.Data "
-                    "FROM "
-                        "FileDataTable, "
-                        "FileNameTable, "
-                        "FolderTable, "
-                        "NamespaceTable "
-                    "WHERE FileDataTable.Id = FileNameTable.FileId "
-                    "AND (FileNameTable.Name = ? OR FileNameTable.Name = ?) "
-                    "AND FileNameTable.FolderId = FolderTable.Id "
-                    "AND FolderTable.Name = ? "
-                    "AND FolderTable.NamespaceId = NamespaceTable.Id "
-                    "AND NamespaceTable.Name = ?"));
-    m_query->bindValue(0, filePath);
-    m_query->bindValue(1, QString(QLatin1String("./") + filePath));
-    m_query->bindValue(2, virtualFolder);
-    m_query->bindValue(3, m_namespace);
-    m_query->exec();
-    if (m_query->next() && m_query->isValid())
-        ba = qUncompress(m_query->value(0).toByteArray());
+    // Readers are kept open for serving many files, so prepare this only once.
+    if (!m_fileDataQuery) {
+        m_fileDataQuery = new QSqlQuery(QSqlDatabase::database(m_uniqueId));
+        m_fileDataQuery->prepare(QLatin1String(
+                        "SELECT "
+                            "FileDataTable.Data "
+                        "FROM "
+                            "FileDataTable, "
+                            "FileNameTable, "
+                            "FolderTable, "
+                            "NamespaceTable "
+                        "WHERE FileDataTable.Id = FileNameTable.FileId "
+                        "AND (FileNameTable.Name = ? OR FileNameTable.Name = ?) "
+                        "AND FileNameTable.FolderId = FolderTable.Id "
+                        "AND FolderTable.Name = ? "
+                        "AND FolderTable.NamespaceId = NamespaceTable.Id "
+                        "AND NamespaceTable.Name = ?"));
+    }
+    m_fileDataQuery->bindValue(0, filePath);
+    m_fileDataQuery->bindValue(1, QString(QLatin1String("./") + filePath));
+    m_fileDataQuery->bindValue(2, virtualFolder);
+    m_fileDataQuery->bindValue(3, m_namespace);
+    m_fileDataQuery->exec();
+    if (m_fileDataQuery->next() && m_fileDataQuery->isValid())
+        ba = qUncompress(m_fileDataQuery->value(0).toByteArray());
+    m_fileDataQuery->finish();
     return ba;
 }
 
@@ -446,18 +451,29 @@ QStringList QHelpDBReader::filterAttributes(const QString &filterName) const
     return lst;
 }
 
-QMultiMap<QString, QByteArray> QHelpDBReader::filesData(const QStringList &filterAttributes,
-                                                        const QString &extensionFilter) const
+/*
+  Calls the handler with the name and the compressed data of each file
+  matching the filter attributes and one of the extensions, in the order
+  of their names, until it returns false. The files are read one by one.
+*/
+void QHelpDBReader::readCompressedFiles(const QStringList &filterAttributes,
+        const QStringList &extensions,
+        const std::function<bool(const QString &, const QByteArray &)> &handler) const
 {
-    QMultiMap<QString, QByteArray> result;
     if (!m_query)
-        return result;
+        return;
 
     QString query;
     QString extension;
-    if (!extensionFilter.isEmpty())
-        extension = QString(QLatin1String("AND FileNameTable.Name "
-                                          "LIKE \'%.%1\'")).arg(extensionFilter);
+    if (!extensions.isEmpty()) {
+        QStringList conditions;
+        for (const QString &extensionFilter : extensions) {
+            conditions.append(QString(QLatin1String("FileNameTable.Name "
+                                                    "LIKE \'%.%1\'")).arg(extensionFilter));
+        }
+        extension = QLatin1String("AND (") + conditions.join(QLatin1String(" OR "))
+                + QLatin1Char(')');
+    }
 
     if (filterAttributes.isEmpty()) {
         query = QString(QLatin1String("SELECT "
@@ -493,11 +509,16 @@ QMultiMap<QString, QByteArray> QHelpDBReader::filesData(const QStringList &filte
                          .arg(extension));
         }
     }
-    m_query->exec(query);
-    while (m_query->next())
-        result.insert(m_query->value(0).toString(), qUncompress(m_query->value(1).toByteArray()));
-
-    return result;
+    query.append(QLatin1String(" ORDER BY 1"));
+
+    // Forward only, so the rows already handled are not kept.
+    QSqlQuery filesQuery(QSqlDatabase::database(m_uniqueId));
+    filesQuery.setForwardOnly(true);
+    filesQuery.exec(query);
+    while (filesQuery.next()) {
+        if (!handler(filesQuery.value(0).toString(), filesQuery.value(1).toByteArray()))
+            break;
+    }
 }
 
 QVariant QHelpDBReader::metaData(const QString &name) const
@@ -15,17 +15,21 @@
 // We mean it.
 //
 
+#include <QtHelp/qhelp_global.h>
+
 #include <QtCore/QObject>
 #include <QtCore/QStringList>
 #include <QtCore/QUrl>
 #include <QtCore/QByteArray>
 #include <QtCore/QSet>
 
+#include <functional>
+
 QT_BEGIN_NAMESPACE
 
 class QSqlQuery;
 
-class QHelpDBReader : public QObject
+class QHELP_EXPORT QHelpDBReader : public QObject
 {
     Q_OBJECT
 
@@ -79,8 +83,8 @@ public:
     QString version() const;
     IndexTable indexTable() const;
     QList<QStringList> filterAttributeSets() const;
-    QMultiMap<QString, QByteArray> filesData(const QStringList &filterAttributes,
-                                             const QString &extensionFilter = QString()) const;
+    void readCompressedFiles(const QStringList &filterAttributes, const QStringList &extensions,
+            const std::function<bool(const QString &, const QByteArray &)> &handler) const;
     QByteArray fileData(const QString &virtualFolder,
         const QString &filePath) const;
 
@@ -99,6 +103,7 @@ private:
     QString m_uniqueId;
     QString m_error;
     QSqlQuery *m_query = nullptr;
+    mutable QSqlQuery *m_fileDataQuery = nullptr;
     mutable QString m_namespace;
 };
 
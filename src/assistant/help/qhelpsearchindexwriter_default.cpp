@@ -5,12 +5,14 @@
 #include "qhelp_global.h"
 #include "qhelpenginecore.h"
 #include "qhelpdbreader_p.h"
+#include "qhelpsearchtextextractor_p.h"
 
 #include <QtCore/QDataStream>
 #include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QStringDecoder>
 #include <QtCore/QTextStream>
+#include <QtCore/QThreadPool>
 #include <QtCore/QSet>
 #include <QtCore/QUrl>
 #include <QtCore/QVariant>
@@ -19,8 +21,6 @@
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
 
-#include <QTextDocument>
-
 QT_BEGIN_NAMESPACE
 
 namespace fulltextsearch {
@@ -327,6 +327,131 @@ static bool clearIndexMap(QHelpEngineCore *engine)
     return engine->removeCustomValue(QLatin1String(IndexedNamespacesKey));
 }
 
+namespace {
+
+struct IndexedFile
+{
+    QString namespaceName;
+    QString attributes;
+    QString url;
+    QByteArray compressedData;
+    QString title;
+    QString contents;
+    bool indexed = false;
+};
+
+// Runs on the worker threads: turns the stored data of the file into the
+// title and the text to index.
+void extractText(IndexedFile *file)
+{
+    const QByteArray data = qUncompress(file->compressedData);
+    file->compressedData = QByteArray();
+    if (data.isEmpty())
+        return;
+
+    QTextStream s(data);
+    auto encoding = QStringDecoder::encodingForHtml(data);
+    if (encoding)
+        s.setEncoding(*encoding);
+
+    const QString &text = s.readAll();
+    if (text.isEmpty())
+        return;
+
+    if (file->url.endsWith(QLatin1String(".txt"))) {
+        file->title = file->url.mid(file->url.lastIndexOf(QLatin1Char('/')) + 1);
+        file->contents = text.toHtmlEscaped();
+    } else {
+        const TextExtractor extractor(text);
+        file->title = extractor.title().toHtmlEscaped();
+        file->contents = extractor.text().toHtmlEscaped();
+    }
+    file->indexed = true;
+}
+
+/*
+  Extracts the text of the files in batches on a pool of worker threads,
+  while the indexing thread reads the next batch from the documentation
+  file. The results are inserted in the order the files were added, and
+  at most two batches are held in memory.
+*/
+class TextExtractionPipeline
+{
+public:
+    explicit TextExtractionPipeline(Writer *writer)
+        : m_writer(writer)
+    {
+        m_pool.setThreadPriority(QThread::LowestPriority);
+    }
+
+    ~TextExtractionPipeline()
+    {
+        cancel();
+    }
+
+    void add(IndexedFile &&file)
+    {
+        m_batchBytes += file.compressedData.size();
+        m_batch.append(std::move(file));
+        if (m_batch.size() >= MaxBatchFiles || m_batchBytes >= MaxBatchBytes)
+            submit();
+    }
+
+    // Inserts all files added so far into the index.
+    void finish()
+    {
+        submit();
+        collect();
+    }
+
+    // Drops the files added so far.
+    void cancel()
+    {
+        m_pool.waitForDone();
+        m_processing.clear();
+        m_batch.clear();
+        m_batchBytes = 0;
+    }
+
+private:
+    enum {
+        MaxBatchFiles = 256,
+        MaxBatchBytes = 4 * 1024 * 1024
+    };
+
+    void submit()
+    {
+        collect();
+        m_processing.swap(m_batch);
+        m_batchBytes = 0;
+        for (IndexedFile &file : m_processing)
+            m_pool.start([&file] { extractText(&file); });
+    }
+
+    void collect()
+    {
+        m_pool.waitForDone();
+        if (m_processing.isEmpty())
+            return;
+        for (const IndexedFile &file : qAsConst(m_processing)) {
+            if (file.indexed) {
+                m_writer->insertDoc(file.namespaceName, file.attributes, file.url,
+                                    file.title, file.contents);
+            }
+        }
+        m_writer->flush();
+        m_processing.clear();
+    }
+
+    Writer *m_writer;
+    QThreadPool m_pool;
+    QList<IndexedFile> m_batch;
+    QList<IndexedFile> m_processing;
+    qsizetype m_batchBytes = 0;
+};
+
+} // namespace
+
 void QHelpSearchIndexWriter::run()
 {
     QMutexLocker lock(&m_mutex);
@@ -393,6 +518,7 @@ void QHelpSearchIndexWriter::run()
         }
     }
 
+    TextExtractionPipeline pipeline(&writer);
     for (const QString &namespaceName : registeredDocs) {
         lock.relock();
         if (m_cancel) {
@@ -419,36 +545,22 @@ void QHelpSearchIndexWriter::run()
         const QList<QStringList> &attributeSets =
             engine.filterAttributeSets(namespaceName);
 
+        bool cancelled = false;
         for (const QStringList &attributes : attributeSets) {
             const QString &attributesString = attributes.join(QLatin1Char('|'));
 
-            const QMultiMap<QString, QByteArray> htmlFiles =
-                    reader.filesData(attributes, QLatin1String("html"));
-            const QMultiMap<QString, QByteArray> htmFiles =
-                    reader.filesData(attributes, QLatin1String("htm"));
-            const QMultiMap<QString, QByteArray> txtFiles =
-                    reader.filesData(attributes, QLatin1String("txt"));
-
-            QMultiMap<QString, QByteArray> files = htmlFiles;
-            files.unite(htmFiles);
-            files.unite(txtFiles);
-
-            for (auto it = files.cbegin(), end = files.cend(); it != end ; ++it) {
+            const QStringList extensions = { QLatin1String("html"), QLatin1String("htm"),
+                                             QLatin1String("txt") };
+            reader.readCompressedFiles(attributes, extensions,
+                                       [&](const QString &file, const QByteArray &data) {
                 lock.relock();
-                if (m_cancel) {
-                    // store what we have done so far
-                    writeIndexMap(&engine, indexMap);
-                    writer.endTransaction();
-                    emit indexingFinished();
-                    return;
-                }
+                cancelled = m_cancel;
                 lock.unlock();
-
-                const QString &file = it.key();
-                const QByteArray &data = it.value();
+                if (cancelled)
+                    return false;
 
                 if (data.isEmpty())
-                    continue;
+                    return true;
 
                 QUrl url;
                 url.setScheme(QLatin1String("qthelp"));
@@ -462,35 +574,29 @@ void QHelpSearchIndexWriter::run()
                 if (!fullFileName.endsWith(QLatin1String(".html"))
                         && !fullFileName.endsWith(QLatin1String(".htm"))
                         && !fullFileName.endsWith(QLatin1String(".txt"))) {
-                    continue;
-                }
-
-                QTextStream s(data);
-                auto encoding = QStringDecoder::encodingForHtml(data);
-                if (encoding)
-                    s.setEncoding(*encoding);
-
-                const QString &text = s.readAll();
-                if (text.isEmpty())
-                    continue;
-
-                QString title;
-                QString contents;
-                if (fullFileName.endsWith(QLatin1String(".txt"))) {
-                    title = fullFileName.mid(fullFileName.lastIndexOf(QLatin1Char('/')) + 1);
-                    contents = text.toHtmlEscaped();
-                } else {
-                    QTextDocument doc;
-                    doc.setHtml(text);
-
-                    title = doc.metaInformation(QTextDocument::DocumentTitle).toHtmlEscaped();
-                    contents = doc.toPlainText().toHtmlEscaped();
+                    return true;
                 }
 
-                writer.insertDoc(namespaceName, attributesString, fullFileName, title, contents);
+                IndexedFile indexedFile;
+                indexedFile.namespaceName = namespaceName;
+                indexedFile.attributes = attributesString;
+                indexedFile.url = fullFileName;
+                indexedFile.compressedData = data;
+                pipeline.add(std::move(indexedFile));
+                return true;
+            });
+
+            if (cancelled) {
+                // store what we have done so far; the batches of this
+                // namespace already written are removed on the next run
+                pipeline.cancel();
+                writeIndexMap(&engine, indexMap);
+                writer.endTransaction();
+                emit indexingFinished();
+                return;
             }
         }
-        writer.flush();
+        pipeline.finish();
         const QString &path = engine.documentationFileName(namespaceName);
         indexMap.insert(namespaceName, QFileInfo(path).lastModified());
     }
@@ -0,0 +1,402 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qhelpsearchtextextractor_p.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace fulltextsearch {
+namespace qt {
+
+namespace {
+
+// Elements starting a new line of text, sorted.
+const char *const blockElements[] = {
+    "address", "article", "aside", "blockquote", "body", "caption", "center",
+    "dd", "div", "dl", "dt", "figcaption", "figure", "footer", "form",
+    "h1", "h2", "h3", "h4", "h5", "h6", "header", "hr", "html", "li", "main",
+    "nav", "ol", "p", "pre", "section", "table", "tbody", "td", "tfoot", "th",
+    "thead", "tr", "ul"
+};
+
+struct Entity
+{
+    const char *name;
+    char16_t value;
+};
+
+// The named character references of HTML 4 that show up in documentation,
+// sorted by name.
+const Entity entities[] = {
+    { "AElig", 0x00c6 }, { "Aacute", 0x00c1 }, { "Acirc", 0x00c2 }, { "Agrave", 0x00c0 },
+    { "Aring", 0x00c5 }, { "Atilde", 0x00c3 }, { "Auml", 0x00c4 }, { "Ccedil", 0x00c7 },
+    { "Dagger", 0x2021 }, { "ETH", 0x00d0 }, { "Eacute", 0x00c9 }, { "Ecirc", 0x00ca },
+    { "Egrave", 0x00c8 }, { "Euml", 0x00cb }, { "Iacute", 0x00cd }, { "Icirc", 0x00ce },
+    { "Igrave", 0x00cc }, { "Iuml", 0x00cf }, { "Ntilde", 0x00d1 }, { "Oacute", 0x00d3 },
+    { "Ocirc", 0x00d4 }, { "Ograve", 0x00d2 }, { "Oslash", 0x00d8 }, { "Otilde", 0x00d5 },
+    { "Ouml", 0x00d6 }, { "THORN", 0x00de }, { "Uacute", 0x00da }, { "Ucirc", 0x00db },
+    { "Ugrave", 0x00d9 }, { "Uuml", 0x00dc }, { "Yacute", 0x00dd },
+    { "aacute", 0x00e1 }, { "acirc", 0x00e2 }, { "acute", 0x00b4 }, { "aelig", 0x00e6 },
+    { "agrave", 0x00e0 }, { "amp", 0x0026 }, { "apos", 0x0027 }, { "aring", 0x00e5 },
+    { "atilde", 0x00e3 }, { "auml", 0x00e4 }, { "bdquo", 0x201e }, { "brvbar", 0x00a6 },
+    { "bull", 0x2022 }, { "ccedil", 0x00e7 }, { "cedil", 0x00b8 }, { "cent", 0x00a2 },
+    { "copy", 0x00a9 }, { "curren", 0x00a4 }, { "dagger", 0x2020 }, { "deg", 0x00b0 },
+    { "divide", 0x00f7 }, { "eacute", 0x00e9 }, { "ecirc", 0x00ea }, { "egrave", 0x00e8 },
+    { "eth", 0x00f0 }, { "euml", 0x00eb }, { "euro", 0x20ac }, { "frac12", 0x00bd },
+    { "frac14", 0x00bc }, { "frac34", 0x00be }, { "gt", 0x003e }, { "hellip", 0x2026 },
+    { "iacute", 0x00ed }, { "icirc", 0x00ee }, { "iexcl", 0x00a1 }, { "igrave", 0x00ec },
+    { "iquest", 0x00bf }, { "iuml", 0x00ef }, { "laquo", 0x00ab }, { "larr", 0x2190 },
+    { "ldquo", 0x201c }, { "lsaquo", 0x2039 }, { "lsquo", 0x2018 }, { "lt", 0x003c },
+    { "macr", 0x00af }, { "mdash", 0x2014 }, { "micro", 0x00b5 }, { "middot", 0x00b7 },
+    { "minus", 0x2212 }, { "nbsp", 0x00a0 }, { "ndash", 0x2013 }, { "not", 0x00ac },
+    { "ntilde", 0x00f1 }, { "oacute", 0x00f3 }, { "ocirc", 0x00f4 }, { "ograve", 0x00f2 },
+    { "ordf", 0x00aa }, { "ordm", 0x00ba }, { "oslash", 0x00f8 }, { "otilde", 0x00f5 },
+    { "ouml", 0x00f6 }, { "para", 0x00b6 }, { "permil", 0x2030 }, { "plusmn", 0x00b1 },
+    { "pound", 0x00a3 }, { "quot", 0x0022 }, { "raquo", 0x00bb }, { "rarr", 0x2192 },
+    { "rdquo", 0x201d }, { "reg", 0x00ae }, { "rsaquo", 0x203a }, { "rsquo", 0x2019 },
+    { "sbquo", 0x201a }, { "sect", 0x00a7 }, { "shy", 0x00ad }, { "sup1", 0x00b9 },
+    { "sup2", 0x00b2 }, { "sup3", 0x00b3 }, { "szlig", 0x00df }, { "thorn", 0x00fe },
+    { "times", 0x00d7 }, { "trade", 0x2122 }, { "uacute", 0x00fa }, { "ucirc", 0x00fb },
+    { "ugrave", 0x00f9 }, { "uml", 0x00a8 }, { "uuml", 0x00fc }, { "yacute", 0x00fd },
+    { "yen", 0x00a5 }, { "yuml", 0x00ff }
+};
+
+enum {
+    MaxEntityLength = 7,
+    MaxTagLength = 15
+};
+
+bool isHtmlSpace(QChar ch)
+{
+    const char16_t c = ch.unicode();
+    return c == u' ' || c == u'\n' || c == u'\t' || c == u'\r' || c == u'\f';
+}
+
+bool isAsciiLetter(char16_t c)
+{
+    return (c >= u'a' && c <= u'z') || (c >= u'A' && c <= u'Z');
+}
+
+bool isNameCharacter(char16_t c)
+{
+    return isAsciiLetter(c) || (c >= u'0' && c <= u'9') || c == u'-' || c == u':';
+}
+
+int digitValue(char16_t c, int base)
+{
+    if (c >= u'0' && c <= u'9')
+        return c - u'0';
+    if (base == 16) {
+        if (c >= u'a' && c <= u'f')
+            return c - u'a' + 10;
+        if (c >= u'A' && c <= u'F')
+            return c - u'A' + 10;
+    }
+    return -1;
+}
+
+bool lessThan(const char *a, const char *b)
+{
+    return strcmp(a, b) < 0;
+}
+
+bool isBlockElement(const char *name)
+{
+    return std::binary_search(std::begin(blockElements), std::end(blockElements), name,
+                              lessThan);
+}
+
+/*
+  Decodes the character reference at pos, which is just after the '&'.
+  Returns the position after the reference, or -1 if there is none.
+*/
+qsizetype decodeEntity(QStringView html, qsizetype pos, char32_t *ch)
+{
+    const qsizetype size = html.size();
+    if (pos < size && html[pos] == u'#') {
+        qsizetype i = pos + 1;
+        int base = 10;
+        if (i < size && (html[i] == u'x' || html[i] == u'X')) {
+            base = 16;
+            ++i;
+        }
+        const qsizetype digitsStart = i;
+        char32_t value = 0;
+        for (; i < size; ++i) {
+            const int digit = digitValue(html[i].unicode(), base);
+            if (digit < 0)
+                break;
+            if (value <= 0x10ffff)
+                value = value * base + digit;
+        }
+        if (i == digitsStart)
+            return -1;
+        if (i < size && html[i] == u';')
+            ++i;
+        if (value == 0 || value > 0x10ffff || QChar::isSurrogate(value))
+            value = QChar::ReplacementCharacter;
+        *ch = value;
+        return i;
+    }
+
+    char name[MaxEntityLength + 1];
+    int length = 0;
+    qsizetype i = pos;
+    for (; i < size && isNameCharacter(html[i].unicode()); ++i) {
+        if (length == MaxEntityLength)
+            return -1;
+        name[length++] = char(html[i].unicode());
+    }
+    if (!length || i == size || html[i] != u';')
+        return -1;
+    name[length] = '\0';
+
+    const auto it = std::lower_bound(std::begin(entities), std::end(entities), name,
+                                     [](const Entity &entity, const char *key) {
+        return strcmp(entity.name, key) < 0;
+    });
+    if (it == std::end(entities) || strcmp(it->name, name))
+        return -1;
+    *ch = it->value;
+    return i + 1;
+}
+
+// The text of a title, with the references decoded.
+QString decodeTitle(QStringView html)
+{
+    QString title;
+    title.reserve(html.size());
+    for (qsizetype i = 0; i < html.size(); ++i) {
+        if (html[i] == u'&') {
+            char32_t ch;
+            const qsizetype next = decodeEntity(html, i + 1, &ch);
+            if (next >= 0) {
+                title += QStringView(QChar::fromUcs4(ch));
+                i = next - 1;
+                continue;
+            }
+        }
+        title += html[i];
+    }
+    return title.simplified();
+}
+
+} // namespace
+
+TextExtractor::TextExtractor(QStringView html)
+    : m_html(html)
+{
+    m_text.reserve(html.size() / 2);
+
+    const qsizetype size = m_html.size();
+    while (m_pos < size) {
+        const QChar ch = m_html[m_pos];
+        if (ch == u'<') {
+            parseMarkup();
+            continue;
+        }
+        ++m_pos;
+        if (m_inHead)
+            continue;
+        if (ch == u'&') {
+            char32_t decoded;
+            const qsizetype next = decodeEntity(m_html, m_pos, &decoded);
+            if (next >= 0) {
+                m_pos = next;
+                appendCharacter(decoded);
+                continue;
+            }
+        }
+        appendText(ch);
+    }
+
+    while (!m_text.isEmpty() && isHtmlSpace(m_text.back()))
+        m_text.chop(1);
+    m_text.squeeze();
+    m_html = QStringView();
+}
+
+void TextExtractor::parseMarkup()
+{
+    const qsizetype size = m_html.size();
+    const QStringView rest = m_html.mid(m_pos);
+
+    if (rest.startsWith(u"<!--")) {
+        const qsizetype end = m_html.indexOf(u"-->", m_pos + 4);
+        m_pos = end < 0 ? size : end + 3;
+        return;
+    }
+
+    const char16_t next = rest.size() > 1 ? rest[1].unicode() : u'\0';
+    if (next == u'!' || next == u'?') {
+        // DOCTYPE, CDATA or processing instruction
+        const qsizetype end = m_html.indexOf(u'>', m_pos);
+        m_pos = end < 0 ? size : end + 1;
+        return;
+    }
+
+    const bool closing = next == u'/';
+    qsizetype i = m_pos + (closing ? 2 : 1);
+    if (i >= size || !isAsciiLetter(m_html[i].unicode())) {
+        // Not a tag, just a '<'.
+        ++m_pos;
+        if (!m_inHead)
+            appendText(u'<');
+        return;
+    }
+
+    char name[MaxTagLength + 1];
+    int length = 0;
+    for (; i < size && isNameCharacter(m_html[i].unicode()); ++i) {
+        if (length < MaxTagLength)
+            name[length++] = char(m_html[i].toLower().unicode());
+        else
+            length = MaxTagLength + 1;
+    }
+    if (length > MaxTagLength)
+        length = 0; // none of the elements we know
+    name[length] = '\0';
+
+    // Quotes only count at the start of attribute values.
+    char16_t quote = u'\0';
+    bool afterEquals = false;
+    for (; i < size; ++i) {
+        const char16_t c = m_html[i].unicode();
+        if (quote) {
+            if (c == quote)
+                quote = u'\0';
+        } else if (c == u'>') {
+            break;
+        } else if (afterEquals && (c == u'"' || c == u'\'')) {
+            quote = c;
+        } else if (c == u'=') {
+            afterEquals = true;
+            continue;
+        }
+        if (!isHtmlSpace(m_html[i]))
+            afterEquals = false;
+    }
+    m_pos = i < size ? i + 1 : size;
+
+    handleTag(name, closing);
+}
+
+void TextExtractor::handleTag(const char *name, bool closing)
+{
+    if (!closing) {
+        if (!strcmp(name, "script") || !strcmp(name, "style")) {
+            skipClosingTag(QLatin1String(name));
+            return;
+        }
+        if (!strcmp(name, "title")) {
+            const qsizetype end = findClosingTag(QLatin1String("title"));
+            const QStringView title = m_html.mid(m_pos, (end < 0 ? m_html.size() : end) - m_pos);
+            if (m_title.isEmpty())
+                m_title = decodeTitle(title);
+            skipClosingTag(QLatin1String("title"));
+            return;
+        }
+        if (!strcmp(name, "head")) {
+            m_inHead = true;
+            return;
+        }
+        if (!strcmp(name, "body"))
+            m_inHead = false;
+    } else if (!strcmp(name, "head")) {
+        m_inHead = false;
+        return;
+    }
+
+    if (m_inHead)
+        return;
+
+    if (!strcmp(name, "br")) {
+        if (!closing) {
+            m_pendingSpace = false;
+            m_text += u'\n';
+        }
+        return;
+    }
+    if (!strcmp(name, "pre")) {
+        if (!closing)
+            ++m_preDepth;
+        else if (m_preDepth)
+            --m_preDepth;
+    }
+    if (isBlockElement(name))
+        startBlock();
+}
+
+// The position of the tag closing the element whose contents start at the
+// current position, or -1 if it is not closed.
+qsizetype TextExtractor::findClosingTag(QLatin1String name) const
+{
+    const qsizetype size = m_html.size();
+    qsizetype i = m_pos;
+    while ((i = m_html.indexOf(u"</", i)) >= 0) {
+        const qsizetype nameEnd = i + 2 + name.size();
+        if (nameEnd <= size
+                && m_html.mid(i + 2, name.size()).compare(name, Qt::CaseInsensitive) == 0
+                && (nameEnd == size || !isNameCharacter(m_html[nameEnd].unicode()))) {
+            return i;
+        }
+        i += 2;
+    }
+    return -1;
+}
+
+// Skips the contents of a raw text element and its closing tag.
+void TextExtractor::skipClosingTag(QLatin1String name)
+{
+    const qsizetype start = findClosingTag(name);
+    const qsizetype end = start < 0 ? -1 : m_html.indexOf(u'>', start);
+    m_pos = end < 0 ? m_html.size() : end + 1;
+}
+
+void TextExtractor::appendCharacter(char32_t ch)
+{
+    if (QChar::requiresSurrogates(ch)) {
+        appendText(QChar(QChar::highSurrogate(ch)));
+        appendText(QChar(QChar::lowSurrogate(ch)));
+    } else {
+        appendText(QChar(char16_t(ch)));
+    }
+}
+
+void TextExtractor::appendText(QChar ch)
+{
+    if (isHtmlSpace(ch)) {
+        if (!m_preDepth) {
+            m_pendingSpace = true;
+            return;
+        }
+        if (ch == u'\r')
+            return;
+    } else if (ch == QChar::Nbsp) {
+        ch = u' ';
+    }
+
+    if (m_pendingSpace) {
+        m_pendingSpace = false;
+        if (!m_text.isEmpty() && m_text.back() != u'\n')
+            m_text += u' ';
+    }
+    m_text += ch;
+}
+
+void TextExtractor::startBlock()
+{
+    m_pendingSpace = false;
+    if (!m_text.isEmpty() && m_text.back() != u'\n')
+        m_text += u'\n';
+}
+
+}   // namespace qt
+}   // namespace fulltextsearch
+
+QT_END_NAMESPACE
@@ -0,0 +1,67 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QHELPSEARCHTEXTEXTRACTOR_H
+#define QHELPSEARCHTEXTEXTRACTOR_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists for the convenience
+// of the help generator tools. This header file may change from version
+// to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtHelp/qhelp_global.h>
+
+#include <QtCore/QString>
+#include <QtCore/QStringView>
+
+QT_BEGIN_NAMESPACE
+
+namespace fulltextsearch {
+namespace qt {
+
+/*
+  Extracts the title and the visible text of an HTML page in a single pass,
+  without building a document. The text is what QTextDocument::toPlainText()
+  gives for the page, as far as searching is concerned: the contents of
+  <head>, <script> and <style> are left out, runs of white space collapse
+  to one space outside of <pre>, block elements start a new line and
+  character references are decoded.
+*/
+class QHELP_EXPORT TextExtractor
+{
+public:
+    explicit TextExtractor(QStringView html);
+
+    QString title() const { return m_title; }
+    QString text() const { return m_text; }
+
+private:
+    void parseMarkup();
+    void handleTag(const char *name, bool closing);
+    qsizetype findClosingTag(QLatin1String name) const;
+    void skipClosingTag(QLatin1String name);
+    void appendCharacter(char32_t ch);
+    void appendText(QChar ch);
+    void startBlock();
+
+    QStringView m_html;
+    qsizetype m_pos = 0;
+    int m_preDepth = 0;
+    bool m_inHead = false;
+    bool m_pendingSpace = false;
+    QString m_title;
+    QString m_text;
+};
+
+}   // namespace qt
+}   // namespace fulltextsearch
+
+QT_END_NAMESPACE
+
+#endif // QHELPSEARCHTEXTEXTRACTOR_H
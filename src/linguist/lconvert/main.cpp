@@ -74,6 +74,11 @@ static int usage(const QStringList &args)
         "           Default is absolute.\n\n"
         "    -no-ui-lines\n"
         "           Drop line numbers from references to UI files.\n\n"
+        "    -stream\n"
+        "           Convert a single TS file to TS one message at a time, without\n"
+        "           loading it first. This keeps the memory use constant for\n"
+        "           large files. Messages stay in input order, and duplicates are\n"
+        "           not merged. Cannot be combined with -sort-contexts.\n\n"
         "    -verbose\n"
         "           be a bit more verbose\n\n"
         "Long options can be specified with only one leading dash, too.\n\n"
@@ -121,6 +126,7 @@ int main(int argc, char *argv[])
     bool noUntranslated = false;
     bool verbose = false;
     bool noUiLines = false;
+    bool stream = false;
     Translator::LocationsType locations = Translator::DefaultLocations;
 
     ConversionData cd;
@@ -190,6 +196,8 @@ int main(int argc, char *argv[])
                 return usage(args);
         } else if (args[i] == QLatin1String("-no-ui-lines")) {
             noUiLines = true;
+        } else if (args[i] == QLatin1String("-stream")) {
+            stream = true;
         } else if (args[i] == QLatin1String("-verbose")) {
             verbose = true;
         } else if (args[i].startsWith(QLatin1Char('-'))) {
@@ -205,6 +213,57 @@ int main(int argc, char *argv[])
     if (inFiles.isEmpty())
         return usage(args);
 
+    if (stream) {
+        if (inFiles.size() != 1 || cd.sortContexts())
+            return usage(args);
+
+        int numPlurals = 1;
+        bool truncated = false;
+        const auto header = [&](Translator &tr) {
+            if (!targetLanguage.isEmpty())
+                tr.setLanguageCode(targetLanguage);
+            if (!sourceLanguage.isEmpty())
+                tr.setSourceLanguageCode(sourceLanguage);
+            numPlurals = Translator::numerusFormCount(tr.languageCode());
+        };
+        // The same steps as below, applied to one message at a time
+        const auto filter = [&](TranslatorMessage &msg) {
+            if (noObsolete && (msg.type() == TranslatorMessage::Obsolete
+                               || msg.type() == TranslatorMessage::Vanished)) {
+                return false;
+            }
+            if (noFinished && msg.type() == TranslatorMessage::Finished)
+                return false;
+            if (noUntranslated && !msg.isTranslated())
+                return false;
+            if (dropTranslations) {
+                if (msg.type() == TranslatorMessage::Finished)
+                    msg.setType(TranslatorMessage::Unfinished);
+                msg.setTranslation(QString());
+            }
+            if (noUiLines)
+                Translator::dropUiLines(msg);
+            const int count = msg.isPlural() ? numPlurals : 1;
+            if (msg.translations().count() != count) {
+                if (msg.translations().count() > count)
+                    truncated = true;
+                msg.setTranslations(Translator::normalizedTranslations(msg, numPlurals));
+            }
+            return true;
+        };
+        if (!Translator::stream(inFiles[0].name, inFiles[0].format, outFileName, outFormat,
+                                cd, locations, header, filter)) {
+            std::cerr << qPrintable(cd.error());
+            return 2;
+        }
+        if (truncated) {
+            std::cerr << "Removed plural forms as the target language has less forms.\n"
+                         "If this sounds wrong, possibly the target language is not set or "
+                         "recognized.\n";
+        }
+        return 0;
+    }
+
     tr.setLanguageCode(Translator::guessLanguageCodeFromFileName(inFiles[0].name));
 
     if (!tr.load(inFiles[0].name, cd, inFiles[0].format)) {
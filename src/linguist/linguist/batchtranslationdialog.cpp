@@ -5,7 +5,9 @@
 #include "phrase.h"
 #include "messagemodel.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QMap>
+#include <QtCore/QThread>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QProgressDialog>
 
@@ -38,6 +40,11 @@ BatchTranslationDialog::BatchTranslationDialog(MultiDataModel *dataModel, QWidge
     m_ui.phrasebookList->setSelectionMode(QAbstractItemView::SingleSelection);
 }
 
+BatchTranslationDialog::~BatchTranslationDialog()
+{
+    stopTranslation();
+}
+
 
 void BatchTranslationDialog::setPhraseBooks(const QList<PhraseBook *> &phrasebooks, int modelIndex)
 {
@@ -71,18 +78,49 @@ void BatchTranslationDialog::setPhraseBooks(const QList<PhraseBook *> &phraseboo
     m_model.sort(0);
 }
 
+namespace {
+
+struct BatchTranslationJob
+{
+    MultiDataIndex index;
+    QString source;
+};
+
+} // namespace
+
+struct BatchTranslationDialog::Result
+{
+    MultiDataIndex index;
+    QString translation;
+};
+
+/*
+  The checked phrase books are compiled into one dictionary, and the messages
+  are looked up in it on a worker thread. The translations found are applied
+  in batches as they come in.
+*/
 void BatchTranslationDialog::startTranslation()
 {
-    int translatedcount = 0;
-    QCursor oldCursor = cursor();
-    setCursor(Qt::BusyCursor);
-    int messageCount = m_dataModel->messageCount();
+    if (m_translationThread)
+        return;
 
-    QProgressDialog *dlgProgress;
-    dlgProgress = new QProgressDialog(tr("Searching, please wait..."), tr("&Cancel"), 0, messageCount, this);
-    dlgProgress->show();
+    // Go through them in the order the user specified in the phrasebookList:
+    // the first phrase with a given source wins.
+    QHash<QString, QString> dictionary;
+    for (int b = 0; b < m_model.rowCount(); ++b) {
+        QModelIndex idx(m_model.index(b, 0));
+        QVariant checkState = m_model.data(idx, Qt::CheckStateRole);
+        if (checkState == Qt::Checked) {
+            PhraseBook *pb = m_phrasebooks[m_model.data(idx, Qt::UserRole).toInt()];
+            const auto phrases = pb->phrases();
+            for (const Phrase *ph : phrases) {
+                if (!dictionary.contains(ph->source()))
+                    dictionary.insert(ph->source(), ph->target());
+            }
+        }
+    }
 
-    int msgidx = 0;
+    QList<BatchTranslationJob> jobs;
     const bool translateTranslated = m_ui.ckTranslateTranslated->isChecked();
     const bool translateFinished = m_ui.ckTranslateFinished->isChecked();
     for (MultiDataModelIterator it(m_dataModel, m_modelIndex); it.isValid(); ++it) {
@@ -90,40 +128,97 @@ void BatchTranslationDialog::startTranslation()
             if (!m->isObsolete()
                 && (translateTranslated || m->translation().isEmpty())
                 && (translateFinished || !m->isFinished())) {
-
-                // Go through them in the order the user specified in the phrasebookList
-                for (int b = 0; b < m_model.rowCount(); ++b) {
-                    QModelIndex idx(m_model.index(b, 0));
-                    QVariant checkState = m_model.data(idx, Qt::CheckStateRole);
-                    if (checkState == Qt::Checked) {
-                        PhraseBook *pb = m_phrasebooks[m_model.data(idx, Qt::UserRole).toInt()];
-                        const auto phrases = pb->phrases();
-                        for (const Phrase *ph : phrases) {
-                            if (ph->source() == m->text()) {
-                                m_dataModel->setTranslation(it, ph->target());
-                                m_dataModel->setFinished(it, m_ui.ckMarkFinished->isChecked());
-                                ++translatedcount;
-                                goto done; // break 2;
-                            }
-                        }
-                    }
-                }
+                jobs.append({ it, m->text() });
             }
         }
-      done:
-        ++msgidx;
-        if (!(msgidx & 15))
-            dlgProgress->setValue(msgidx);
-        qApp->processEvents();
-        if (dlgProgress->wasCanceled())
-            break;
     }
-    dlgProgress->hide();
 
-    setCursor(oldCursor);
+    m_translatedCount = 0;
+    setCursor(Qt::BusyCursor);
+    m_ui.runButton->setEnabled(false);
+    m_progressDialog = new QProgressDialog(tr("Searching, please wait..."), tr("&Cancel"),
+                                           0, jobs.size(), this);
+    m_progressDialog->setWindowModality(Qt::WindowModal);
+    m_progressDialog->setAutoClose(false);
+    m_progressDialog->setAutoReset(false);
+    connect(m_progressDialog, &QProgressDialog::canceled,
+            this, &BatchTranslationDialog::cancelTranslation);
+    m_progressDialog->show();
+
+    const int generation = m_translationGeneration;
+    m_translationCanceled = false;
+    m_translationThread = QThread::create([this, jobs, dictionary, generation] {
+        const auto post = [this, generation](QList<Result> &results, int processed) {
+            QMetaObject::invokeMethod(this, [this, generation, batch = std::move(results),
+                                             processed] {
+                applyTranslations(generation, batch, processed);
+            }, Qt::QueuedConnection);
+            results.clear();
+        };
+        QList<Result> results;
+        for (int i = 0; i < jobs.size(); ++i) {
+            if (m_translationCanceled)
+                return;
+            const auto t = dictionary.constFind(jobs.at(i).source);
+            if (t != dictionary.cend())
+                results.append({ jobs.at(i).index, *t });
+            if (!((i + 1) % 500))
+                post(results, i + 1);
+        }
+        // The last batch is posted even if empty, as it completes the run.
+        post(results, jobs.size());
+    });
+    m_translationThread->start();
+}
+
+void BatchTranslationDialog::applyTranslations(int generation, const QList<Result> &results,
+                                               int processed)
+{
+    if (generation != m_translationGeneration)
+        return;
+
+    const bool markFinished = m_ui.ckMarkFinished->isChecked();
+    for (const Result &result : results) {
+        m_dataModel->setTranslation(result.index, result.translation);
+        m_dataModel->setFinished(result.index, markFinished);
+    }
+    m_translatedCount += results.size();
+    m_progressDialog->setValue(processed);
+    if (processed == m_progressDialog->maximum())
+        finishTranslation();
+}
+
+void BatchTranslationDialog::cancelTranslation()
+{
+    // Keep what was translated so far.
+    if (m_translationThread)
+        finishTranslation();
+}
+
+void BatchTranslationDialog::stopTranslation()
+{
+    if (m_translationThread) {
+        m_translationCanceled = true;
+        m_translationThread->wait();
+        delete m_translationThread;
+        m_translationThread = nullptr;
+    }
+    // Drop the results which are still queued.
+    ++m_translationGeneration;
+}
+
+void BatchTranslationDialog::finishTranslation()
+{
+    stopTranslation();
+    m_progressDialog->hide();
+    m_progressDialog->deleteLater();
+    m_progressDialog = nullptr;
+    m_ui.runButton->setEnabled(true);
+    unsetCursor();
+
     emit finished();
     QMessageBox::information(this, tr("Linguist batch translator"),
-        tr("Batch translated %n entries", "", translatedcount), QMessageBox::Ok);
+        tr("Batch translated %n entries", "", m_translatedCount), QMessageBox::Ok);
 }
 
 void BatchTranslationDialog::movePhraseBookUp()
@@ -10,9 +10,13 @@
 #include <QtWidgets/QDialog>
 #include <QtGui/QStandardItemModel>
 
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
 class MultiDataModel;
+class QProgressDialog;
+class QThread;
 
 class CheckableListModel : public QStandardItemModel
 {
@@ -26,6 +30,7 @@ class BatchTranslationDialog : public QDialog
     Q_OBJECT
 public:
     BatchTranslationDialog(MultiDataModel *model, QWidget *w = 0);
+    ~BatchTranslationDialog();
     void setPhraseBooks(const QList<PhraseBook *> &phrasebooks, int modelIndex);
 
 signals:
@@ -35,13 +40,25 @@ private slots:
     void startTranslation();
     void movePhraseBookUp();
     void movePhraseBookDown();
+    void cancelTranslation();
 
 private:
+    struct Result;
+    void applyTranslations(int generation, const QList<Result> &results, int processed);
+    void stopTranslation();
+    void finishTranslation();
+
     Ui::BatchTranslationDialog m_ui;
     CheckableListModel m_model;
     MultiDataModel *m_dataModel;
     QList<PhraseBook *> m_phrasebooks;
     int m_modelIndex;
+
+    QThread *m_translationThread = nullptr;
+    std::atomic<bool> m_translationCanceled{false};
+    int m_translationGeneration = 0;
+    QProgressDialog *m_progressDialog = nullptr;
+    int m_translatedCount = 0;
 };
 
 QT_END_NAMESPACE
@@ -54,6 +54,8 @@
 #include <QStackedWidget>
 #include <QStatusBar>
 #include <QTextStream>
+#include <QThread>
+#include <QTimer>
 #include <QToolBar>
 #include <QUrl>
 #include <QWhatsThis>
@@ -64,6 +66,15 @@ QT_BEGIN_NAMESPACE
 
 static const int MessageMS = 2500;
 
+// The validation checks, cached as bit masks in MessageItem
+enum ValidationCheck {
+    AcceleratorCheck = 0x1,
+    SurroundingWhitespaceCheck = 0x2,
+    EndingPunctuationCheck = 0x4,
+    PhraseMatchCheck = 0x8,
+    PlaceMarkerCheck = 0x10
+};
+
 enum Ending {
     End_None,
     End_FullStop,
@@ -338,9 +349,14 @@ MainWindow::MainWindow()
     m_phrasesDock->setAllowedAreas(Qt::AllDockWidgetAreas);
     m_phrasesDock->setWindowTitle(tr("Phrases and guesses"));
 
-    m_phraseView = new PhraseView(m_dataModel, &m_phraseDict, this);
+    m_phraseView = new PhraseView(m_dataModel, &m_phraseMatchers, this);
     m_phrasesDock->setWidget(m_phraseView);
 
+    m_phraseDictTimer = new QTimer(this);
+    m_phraseDictTimer->setSingleShot(true);
+    m_phraseDictTimer->setInterval(500);
+    connect(m_phraseDictTimer, &QTimer::timeout, this, &MainWindow::updateChangedPhraseDicts);
+
     // Set up source code and form preview dock widget
     m_sourceAndFormDock = new QDockWidget(this);
     m_sourceAndFormDock->setObjectName(QLatin1String("SourceAndFormDock"));
@@ -439,6 +455,9 @@ MainWindow::MainWindow()
             this, &MainWindow::translationChanged);
     connect(m_dataModel, &MultiDataModel::languageChanged,
             this, &MainWindow::updatePhraseDict);
+    connect(m_dataModel, &MultiDataModel::languageChanged, this, [this](int model) {
+        invalidateChecks(model, EndingPunctuationCheck | PlaceMarkerCheck);
+    });
 
     setWindowModified(m_dataModel->isModified());
     m_modifiedLabel->setVisible(m_dataModel->isModified());
@@ -483,6 +502,7 @@ MainWindow::MainWindow()
 
 MainWindow::~MainWindow()
 {
+    stopValidation();
     writeConfig();
     if (m_assistantProcess && m_assistantProcess->state() == QProcess::Running) {
         m_assistantProcess->terminate();
@@ -669,10 +689,10 @@ bool MainWindow::openFiles(const QStringList &names, bool globalReadWrite)
     m_messageView->setUpdatesEnabled(false);
     int totalCount = 0;
     for (const OpenedFile &op : qAsConst(opened)) {
-        m_phraseDict.append(QHash<QString, QList<Phrase *> >());
+        m_phraseMatchers.append(PhraseMatcher());
         m_dataModel->append(op.dataModel, op.readWrite);
         if (op.readWrite)
-            updatePhraseDictInternal(m_phraseDict.size() - 1);
+            updatePhraseDictInternal(m_phraseMatchers.size() - 1);
         totalCount += op.dataModel->messageCount();
     }
     statusBar()->showMessage(tr("%n translation unit(s) loaded.", 0, totalCount), MessageMS);
@@ -704,18 +724,24 @@ void MainWindow::closeFile()
 {
     int model = m_currentIndex.model();
     if (model >= 0 && maybeSave(model)) {
-        m_phraseDict.removeAt(model);
+        // Pending validation results refer to the old model numbers, so they
+        // are dropped, and whatever they would have set is checked again.
+        // Messages whose checks already ran are not checked twice.
+        stopValidation();
+        m_phraseMatchers.removeAt(model);
         m_contextView->setUpdatesEnabled(false);
         m_messageView->setUpdatesEnabled(false);
         m_dataModel->close(model);
         modelCountChanged();
+        revalidate();
     }
 }
 
 bool MainWindow::closeAll()
 {
     if (maybeSaveAll()) {
-        m_phraseDict.clear();
+        stopValidation();
+        m_phraseMatchers.clear();
         m_contextView->setUpdatesEnabled(false);
         m_messageView->setUpdatesEnabled(false);
         m_dataModel->closeAll();
@@ -1204,9 +1230,9 @@ void MainWindow::closePhraseBook(QAction *action)
     m_ui.menuPrintPhraseBook->removeAction(act);
 
     m_phraseBooks.removeOne(pb);
-    disconnect(pb, &PhraseBook::listChanged,
-               this, &MainWindow::updatePhraseDicts);
-    updatePhraseDicts();
+    disconnect(pb, nullptr, this, nullptr);
+    m_changedPhraseBooks.insert(pb);
+    updateChangedPhraseDicts();
     delete pb;
     updatePhraseBookActions();
 }
@@ -1217,7 +1243,7 @@ void MainWindow::editPhraseBook(QAction *action)
     PhraseBookBox box(pb, this);
     box.exec();
 
-    updatePhraseDicts();
+    updateChangedPhraseDicts();
 }
 
 void MainWindow::printPhraseBook(QAction *action)
@@ -1532,7 +1558,7 @@ void MainWindow::translationChanged(const MultiDataIndex &index)
         m_formPreviewView->setSourceContext(index.model(), m);
 }
 
-// This and the following function operate directly on the messageitem,
+// This and the following function change the message quietly,
 // so the model does not emit modification notifications.
 void MainWindow::updateTranslation(const QStringList &translations)
 {
@@ -1542,7 +1568,7 @@ void MainWindow::updateTranslation(const QStringList &translations)
     if (translations == m->translations())
         return;
 
-    m->setTranslations(translations);
+    m_dataModel->updateTranslations(m_currentIndex, translations);
     if (!m->fileName().isEmpty() && hasFormPreview(m->fileName()))
         m_formPreviewView->setSourceContext(m_currentIndex.model(), m);
     updateDanger(m_currentIndex, true);
@@ -1776,19 +1802,339 @@ void MainWindow::findNext(const QString &text, DataModel::FindLocation where,
     findAgain();
 }
 
+static bool haveMnemonic(const QString &str)
+{
+    for (const ushort *p = (ushort *)str.constData();; ) { // Assume null-termination
+        ushort c = *p++;
+        if (!c)
+            break;
+        if (c == '&') {
+            c = *p++;
+            if (!c)
+                return false;
+            // "Nobody" ever really uses these alt-space, and they are highly annoying
+            // because we get a lot of false positives.
+            if (c != '&' && c != ' ' && QChar(c).isPrint()) {
+                const ushort *pp = p;
+                for (; *p < 256 && isalpha(*p); p++) ;
+                if (pp == p || *p != ';')
+                    return true;
+                // This looks like a HTML &entity;, so ignore it. As a HTML string
+                // won't contain accels anyway, we can stop scanning here.
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+namespace {
+
+struct ValidationError
+{
+    ErrorsView::ErrorType type;
+    QString arg;
+};
+
+// What the checks need to know about a model, so they can run off the GUI thread
+struct ValidationModel
+{
+    QLocale::Language sourceLanguage;
+    QLocale::Language language;
+    QList<bool> countRefNeeds;
+    PhraseMatcher phrases;
+};
+
+struct ValidationJob
+{
+    MultiDataIndex index;
+    int revision;
+    int checks;
+    QString source;
+    QStringList translations;
+    bool plural;
+};
+
+} // namespace
+
+struct MainWindow::ValidationResult
+{
+    MultiDataIndex index;
+    int revision;
+    int checks;
+    int failed;
+};
+
+static ValidationModel validationModel(MultiDataModel *dataModel, int model,
+    const PhraseMatcher &phrases)
+{
+    return { dataModel->sourceLanguage(model), dataModel->language(model),
+             dataModel->model(model)->countRefNeeds(), phrases };
+}
+
+/*
+  Runs the given checks on a translated message and returns those that failed.
+  This does not touch any widget or model, so it is safe to call from any thread.
+*/
+static int validateMessage(int checks, const QString &source, QStringList translations,
+    bool plural, const ValidationModel &model, QList<ValidationError> *errors = nullptr)
+{
+    int failed = 0;
+    const auto fail = [&failed, errors](int check, ErrorsView::ErrorType type,
+                                        const QString &arg = QString()) {
+        failed |= check;
+        if (errors)
+            errors->append({ type, arg });
+    };
+
+    // Truncated variants are permitted to be "denormalized"
+    for (int i = 0; i < translations.count(); ++i) {
+        int sep = translations.at(i).indexOf(QChar(Translator::BinaryVariantSeparator));
+        if (sep >= 0)
+            translations[i].truncate(sep);
+    }
+
+    if (checks & AcceleratorCheck) {
+        bool sk = haveMnemonic(source);
+        bool tk = true;
+        for (int i = 0; i < translations.count() && tk; ++i) {
+            tk &= haveMnemonic(translations[i]);
+        }
+
+        if (!sk && tk)
+            fail(AcceleratorCheck, ErrorsView::SuperfluousAccelerator);
+        else if (sk && !tk)
+            fail(AcceleratorCheck, ErrorsView::MissingAccelerator);
+    }
+    if (checks & SurroundingWhitespaceCheck) {
+        bool whitespaceok = true;
+        for (int i = 0; i < translations.count() && whitespaceok; ++i) {
+            whitespaceok &= (leadingWhitespace(source) == leadingWhitespace(translations[i]));
+            whitespaceok &= (trailingWhitespace(source) == trailingWhitespace(translations[i]));
+        }
+
+        if (!whitespaceok)
+            fail(SurroundingWhitespaceCheck, ErrorsView::SurroundingWhitespaceDiffers);
+    }
+    if (checks & EndingPunctuationCheck) {
+        bool endingok = true;
+        for (int i = 0; i < translations.count() && endingok; ++i) {
+            endingok &= (ending(source, model.sourceLanguage) ==
+                        ending(translations[i], model.language));
+        }
+
+        if (!endingok)
+            fail(EndingPunctuationCheck, ErrorsView::PunctuationDiffers);
+    }
+    if (checks & PhraseMatchCheck) {
+        const QString fsource = MainWindow::friendlyString(source);
+        if (model.phrases.isPhraseIgnored(fsource, MainWindow::friendlyString(translations.first()))) {
+            // Reported for each occurrence of the keyword of the phrase
+            const QStringList lookupWords = fsource.split(QLatin1Char(' '));
+            for (const QString &s : lookupWords) {
+                if (s == lookupWords.first())
+                    fail(PhraseMatchCheck, ErrorsView::IgnoredPhrasebook, s);
+            }
+        }
+    }
+
+    if (checks & PlaceMarkerCheck) {
+        // Stores the occurrence count of the place markers in the map placeMarkerIndexes.
+        // i.e. the occurrence count of %1 is stored at placeMarkerIndexes[1],
+        // count of %2 is stored at placeMarkerIndexes[2] etc.
+        // In the first pass, it counts all place markers in the sourcetext.
+        // In the second pass it (de)counts all place markers in the translation.
+        // When finished, all elements should have returned to a count of 0,
+        // if not there is a mismatch
+        // between place markers in the source text and the translation text.
+        QHash<int, int> placeMarkerIndexes;
+        QString translation;
+        int numTranslations = translations.count();
+        for (int pass = 0; pass < numTranslations + 1; ++pass) {
+            const QChar *uc_begin = source.unicode();
+            const QChar *uc_end = uc_begin + source.length();
+            if (pass >= 1) {
+                translation = translations[pass - 1];
+                uc_begin = translation.unicode();
+                uc_end = uc_begin + translation.length();
+            }
+            const QChar *c = uc_begin;
+            while (c < uc_end) {
+                if (c->unicode() == '%') {
+                    const QChar *escape_start = ++c;
+                    while (c->isDigit())
+                        ++c;
+                    const QChar *escape_end = c;
+                    bool ok = true;
+                    int markerIndex = QString::fromRawData(
+                            escape_start, escape_end - escape_start).toInt(&ok);
+                    if (ok)
+                        placeMarkerIndexes[markerIndex] += (pass == 0 ? numTranslations : -1);
+                }
+                ++c;
+            }
+        }
+
+        for (int i : qAsConst(placeMarkerIndexes)) {
+            if (i != 0) {
+                fail(PlaceMarkerCheck, ErrorsView::PlaceMarkersDiffer);
+                break;
+            }
+        }
+
+        // Piggy-backed on the general place markers, we check the plural count marker.
+        if (plural) {
+            for (int i = 0; i < numTranslations; ++i)
+                if (model.countRefNeeds.at(i)
+                    && !(translations[i].contains(QLatin1String("%n"))
+                    || translations[i].contains(QLatin1String("%Ln")))) {
+                    fail(PlaceMarkerCheck, ErrorsView::NumerusMarkerMissing);
+                    break;
+                }
+        }
+    }
+
+    return failed;
+}
+
+/*
+  Updates the danger flags of all messages. Checks whose results are cached in
+  the messages are not run again; the rest runs on a worker thread, which
+  streams its results back.
+*/
 void MainWindow::revalidate()
 {
-    for (MultiDataModelIterator it(m_dataModel, -1); it.isValid(); ++it)
-        updateDanger(it, false);
+    stopValidation();
+
+    QList<ValidationModel> models;
+    for (int mi = 0; mi < m_dataModel->modelCount(); ++mi)
+        models.append(validationModel(m_dataModel, mi, m_phraseMatchers.at(mi)));
+
+    const int checks = enabledChecks();
+    QList<ValidationJob> jobs;
+    for (MultiDataModelIterator it(m_dataModel, -1); it.isValid(); ++it) {
+        MultiDataIndex curIdx = it;
+        QString source;
+        for (int mi = 0; mi < m_dataModel->modelCount(); ++mi) {
+            if (!m_dataModel->isModelWritable(mi))
+                continue;
+            curIdx.setModel(mi);
+            MessageItem *m = m_dataModel->messageItem(curIdx);
+            if (!m || m->isObsolete())
+                continue;
+
+            if (!m->message().isTranslated()) {
+                if (m->danger())
+                    m_dataModel->setDanger(curIdx, false);
+                continue;
+            }
+            if (source.isEmpty()) {
+                source = m->pluralText();
+                if (source.isEmpty())
+                    source = m->text();
+            }
+            const int missing = checks & ~m->validatedChecks();
+            if (missing) {
+                jobs.append({ curIdx, m->revision(), missing, source, m->translations(),
+                              m->message().isPlural() });
+            } else {
+                const bool danger = (m->failedChecks() & checks) != 0;
+                if (danger != m->danger())
+                    m_dataModel->setDanger(curIdx, danger);
+            }
+        }
+    }
 
     if (m_currentIndex.isValid())
         updateDanger(m_currentIndex, true);
+
+    if (jobs.isEmpty())
+        return;
+
+    const int generation = m_validationGeneration;
+    m_validationCanceled = false;
+    m_validationThread = QThread::create([this, jobs, models, generation] {
+        const auto post = [this, generation](QList<ValidationResult> &results) {
+            QMetaObject::invokeMethod(this, [this, generation, batch = std::move(results)] {
+                applyValidationResults(generation, batch);
+            }, Qt::QueuedConnection);
+            results.clear();
+        };
+        QList<ValidationResult> results;
+        for (const ValidationJob &job : jobs) {
+            if (m_validationCanceled)
+                return;
+            const int failed = validateMessage(job.checks, job.source, job.translations,
+                                               job.plural, models.at(job.index.model()));
+            results.append({ job.index, job.revision, job.checks, failed });
+            if (results.size() == 500)
+                post(results);
+        }
+        if (!results.isEmpty())
+            post(results);
+    });
+    m_validationThread->start(QThread::LowPriority);
+}
+
+void MainWindow::stopValidation()
+{
+    if (m_validationThread) {
+        m_validationCanceled = true;
+        m_validationThread->wait();
+        delete m_validationThread;
+        m_validationThread = nullptr;
+    }
+    // Drop the results which are still queued.
+    ++m_validationGeneration;
+}
+
+void MainWindow::applyValidationResults(int generation, const QList<ValidationResult> &results)
+{
+    if (generation != m_validationGeneration)
+        return;
+
+    const int checks = enabledChecks();
+    for (const ValidationResult &result : results) {
+        MessageItem *m = m_dataModel->messageItem(result.index);
+        // Skip messages which were edited meanwhile.
+        if (!m || m->revision() != result.revision)
+            continue;
+        m->setCheckResults(result.checks, result.failed);
+        const bool danger = (m->failedChecks() & checks) != 0;
+        if (danger != m->danger())
+            m_dataModel->setDanger(result.index, danger);
+    }
+}
+
+int MainWindow::enabledChecks() const
+{
+    int checks = 0;
+    if (m_ui.actionAccelerators->isChecked())
+        checks |= AcceleratorCheck;
+    if (m_ui.actionSurroundingWhitespace->isChecked())
+        checks |= SurroundingWhitespaceCheck;
+    if (m_ui.actionEndingPunctuation->isChecked())
+        checks |= EndingPunctuationCheck;
+    if (m_ui.actionPhraseMatches->isChecked())
+        checks |= PhraseMatchCheck;
+    if (m_ui.actionPlaceMarkerMatches->isChecked())
+        checks |= PlaceMarkerCheck;
+    return checks;
+}
+
+void MainWindow::invalidateChecks(int model, int checks)
+{
+    for (MultiDataModelIterator it(m_dataModel, model); it.isValid(); ++it) {
+        if (MessageItem *m = it.current())
+            m->invalidateChecks(checks);
+    }
 }
 
 QString MainWindow::friendlyString(const QString& str)
 {
     QString f = str.toLower();
-    f.replace(QRegularExpression(QString(QLatin1String("[.,:;!?()-]"))), QString(QLatin1String(" ")));
+    static const QRegularExpression punctuation(QString(QLatin1String("[.,:;!?()-]")));
+    f.replace(punctuation, QString(QLatin1String(" ")));
     f.remove(QLatin1Char('&'));
     return f.simplified();
 }
@@ -2313,8 +2659,20 @@ PhraseBook *MainWindow::doOpenPhraseBook(const QString& name)
     m_phraseBookMenu[PhrasePrintMenu].insert(a, pb);
     a->setWhatsThis(tr("Print the entries in this phrase book."));
 
-    connect(pb, &PhraseBook::listChanged, this, &MainWindow::updatePhraseDicts);
-    updatePhraseDicts();
+    // Phrases added or removed must be taken over at once, as the matchers
+    // point to them. Edits to their texts are taken over once typing pauses.
+    connect(pb, &PhraseBook::listChanged, this, [this, pb] {
+        m_changedPhraseBooks.insert(pb);
+        updateChangedPhraseDicts();
+    });
+    connect(pb, &PhraseBook::phraseTextChanged, this, [this, pb] {
+        phraseBookChanged(pb);
+    });
+    // A book for another language applies to other models, and the order of
+    // the phrases depends on the country
+    connect(pb, &PhraseBook::languageChanged, this, &MainWindow::updatePhraseDicts);
+    m_changedPhraseBooks.insert(pb);
+    updateChangedPhraseDicts();
     updatePhraseBookActions();
 
     return pb;
@@ -2390,20 +2748,23 @@ void MainWindow::updatePhraseBookActions()
     m_ui.actionAddToPhraseBook->setEnabled(currentMessageIndex().isValid() && phraseBookLoaded);
 }
 
+static bool isPhraseBookFor(const PhraseBook *pb, QLocale::Language language)
+{
+    return pb->language() == QLocale::C || language == QLocale::C
+            || pb->language() == language;
+}
+
 void MainWindow::updatePhraseDictInternal(int model)
 {
-    QHash<QString, QList<Phrase *> > &pd = m_phraseDict[model];
+    // keyword -> list of appropriate phrases in the phrasebooks
+    QHash<QString, QList<Phrase *> > pd;
 
-    pd.clear();
     for (PhraseBook *pb : qAsConst(m_phraseBooks)) {
-        bool before;
-        if (pb->language() != QLocale::C && m_dataModel->language(model) != QLocale::C) {
-            if (pb->language() != m_dataModel->language(model))
-                continue;
-            before = (pb->country() == m_dataModel->model(model)->country());
-        } else {
-            before = false;
-        }
+        if (!isPhraseBookFor(pb, m_dataModel->language(model)))
+            continue;
+        const bool before = pb->language() != QLocale::C
+                && m_dataModel->language(model) != QLocale::C
+                && pb->country() == m_dataModel->model(model)->country();
         const auto phrases = pb->phrases();
         for (Phrase *p : phrases) {
             QString f = friendlyString(p->source());
@@ -2419,6 +2780,8 @@ void MainWindow::updatePhraseDictInternal(int model)
             }
         }
     }
+    m_phraseMatchers[model] = PhraseMatcher(pd);
+    invalidateChecks(model, PhraseMatchCheck);
 }
 
 void MainWindow::updatePhraseDict(int model)
@@ -2429,39 +2792,54 @@ void MainWindow::updatePhraseDict(int model)
 
 void MainWindow::updatePhraseDicts()
 {
-    for (int i = 0; i < m_phraseDict.size(); ++i)
+    m_phraseDictTimer->stop();
+    m_changedPhraseBooks.clear();
+    for (int i = 0; i < m_phraseMatchers.size(); ++i)
         if (!m_dataModel->isModelWritable(i))
-            m_phraseDict[i].clear();
+            m_phraseMatchers[i] = PhraseMatcher();
         else
             updatePhraseDictInternal(i);
     revalidate();
     m_phraseView->update();
 }
 
-static bool haveMnemonic(const QString &str)
+/*
+  Called for every keystroke in the phrase book editor, so the matchers are
+  only rebuilt once the edits pause.
+*/
+void MainWindow::phraseBookChanged(PhraseBook *pb)
 {
-    for (const ushort *p = (ushort *)str.constData();; ) { // Assume null-termination
-        ushort c = *p++;
-        if (!c)
-            break;
-        if (c == '&') {
-            c = *p++;
-            if (!c)
-                return false;
-            // "Nobody" ever really uses these alt-space, and they are highly annoying
-            // because we get a lot of false positives.
-            if (c != '&' && c != ' ' && QChar(c).isPrint()) {
-                const ushort *pp = p;
-                for (; *p < 256 && isalpha(*p); p++) ;
-                if (pp == p || *p != ';')
-                    return true;
-                // This looks like a HTML &entity;, so ignore it. As a HTML string
-                // won't contain accels anyway, we can stop scanning here.
+    m_changedPhraseBooks.insert(pb);
+    m_phraseDictTimer->start();
+}
+
+/*
+  Rebuilds the matchers of the models the changed phrase books apply to, and
+  re-runs the phrase check on their messages.
+*/
+void MainWindow::updateChangedPhraseDicts()
+{
+    m_phraseDictTimer->stop();
+    if (m_changedPhraseBooks.isEmpty())
+        return;
+
+    bool updated = false;
+    for (int i = 0; i < m_phraseMatchers.size(); ++i) {
+        if (!m_dataModel->isModelWritable(i))
+            continue;
+        for (const PhraseBook *pb : qAsConst(m_changedPhraseBooks)) {
+            if (isPhraseBookFor(pb, m_dataModel->language(i))) {
+                updatePhraseDictInternal(i);
+                updated = true;
                 break;
             }
         }
     }
-    return false;
+    m_changedPhraseBooks.clear();
+    if (updated) {
+        revalidate();
+        m_phraseView->update();
+    }
 }
 
 void MainWindow::updateDanger(const MultiDataIndex &index, bool verbose)
@@ -2469,6 +2847,7 @@ void MainWindow::updateDanger(const MultiDataIndex &index, bool verbose)
     MultiDataIndex curIdx = index;
     m_errorsView->clear();
 
+    const int checks = enabledChecks();
     QString source;
     for (int mi = 0; mi < m_dataModel->modelCount(); ++mi) {
         if (!m_dataModel->isModelWritable(mi))
@@ -2485,146 +2864,15 @@ void MainWindow::updateDanger(const MultiDataIndex &index, bool verbose)
                 if (source.isEmpty())
                     source = m->text();
             }
-            QStringList translations = m->translations();
-
-            // Truncated variants are permitted to be "denormalized"
-            for (int i = 0; i < translations.count(); ++i) {
-                int sep = translations.at(i).indexOf(QChar(Translator::BinaryVariantSeparator));
-                if (sep >= 0)
-                    translations[i].truncate(sep);
-            }
-
-            if (m_ui.actionAccelerators->isChecked()) {
-                bool sk = haveMnemonic(source);
-                bool tk = true;
-                for (int i = 0; i < translations.count() && tk; ++i) {
-                    tk &= haveMnemonic(translations[i]);
-                }
-
-                if (!sk && tk) {
-                    if (verbose)
-                        m_errorsView->addError(mi, ErrorsView::SuperfluousAccelerator);
-                    danger = true;
-                } else if (sk && !tk) {
-                    if (verbose)
-                        m_errorsView->addError(mi, ErrorsView::MissingAccelerator);
-                    danger = true;
-                }
-            }
-            if (m_ui.actionSurroundingWhitespace->isChecked()) {
-                bool whitespaceok = true;
-                for (int i = 0; i < translations.count() && whitespaceok; ++i) {
-                    whitespaceok &= (leadingWhitespace(source) == leadingWhitespace(translations[i]));
-                    whitespaceok &= (trailingWhitespace(source) == trailingWhitespace(translations[i]));
-                }
-
-                if (!whitespaceok) {
-                    if (verbose)
-                        m_errorsView->addError(mi, ErrorsView::SurroundingWhitespaceDiffers);
-                    danger = true;
-                }
-            }
-            if (m_ui.actionEndingPunctuation->isChecked()) {
-                bool endingok = true;
-                for (int i = 0; i < translations.count() && endingok; ++i) {
-                    endingok &= (ending(source, m_dataModel->sourceLanguage(mi)) ==
-                                ending(translations[i], m_dataModel->language(mi)));
-                }
-
-                if (!endingok) {
-                    if (verbose)
-                        m_errorsView->addError(mi, ErrorsView::PunctuationDiffers);
-                    danger = true;
-                }
-            }
-            if (m_ui.actionPhraseMatches->isChecked()) {
-                QString fsource = friendlyString(source);
-                QString ftranslation = friendlyString(translations.first());
-                QStringList lookupWords = fsource.split(QLatin1Char(' '));
-
-                bool phraseFound;
-                for (const QString &s : qAsConst(lookupWords)) {
-                    if (m_phraseDict[mi].contains(s)) {
-                        phraseFound = true;
-                        const auto phrases = m_phraseDict[mi].value(s);
-                        for (const Phrase *p : phrases) {
-                            if (fsource == friendlyString(p->source())) {
-                                if (ftranslation.indexOf(friendlyString(p->target())) >= 0) {
-                                    phraseFound = true;
-                                    break;
-                                } else {
-                                    phraseFound = false;
-                                }
-                            }
-                        }
-                        if (!phraseFound) {
-                            if (verbose)
-                                m_errorsView->addError(mi, ErrorsView::IgnoredPhrasebook, s);
-                            danger = true;
-                        }
-                    }
-                }
-            }
-
-            if (m_ui.actionPlaceMarkerMatches->isChecked()) {
-                // Stores the occurrence count of the place markers in the map placeMarkerIndexes.
-                // i.e. the occurrence count of %1 is stored at placeMarkerIndexes[1],
-                // count of %2 is stored at placeMarkerIndexes[2] etc.
-                // In the first pass, it counts all place markers in the sourcetext.
-                // In the second pass it (de)counts all place markers in the translation.
-                // When finished, all elements should have returned to a count of 0,
-                // if not there is a mismatch
-                // between place markers in the source text and the translation text.
-                QHash<int, int> placeMarkerIndexes;
-                QString translation;
-                int numTranslations = translations.count();
-                for (int pass = 0; pass < numTranslations + 1; ++pass) {
-                    const QChar *uc_begin = source.unicode();
-                    const QChar *uc_end = uc_begin + source.length();
-                    if (pass >= 1) {
-                        translation = translations[pass - 1];
-                        uc_begin = translation.unicode();
-                        uc_end = uc_begin + translation.length();
-                    }
-                    const QChar *c = uc_begin;
-                    while (c < uc_end) {
-                        if (c->unicode() == '%') {
-                            const QChar *escape_start = ++c;
-                            while (c->isDigit())
-                                ++c;
-                            const QChar *escape_end = c;
-                            bool ok = true;
-                            int markerIndex = QString::fromRawData(
-                                    escape_start, escape_end - escape_start).toInt(&ok);
-                            if (ok)
-                                placeMarkerIndexes[markerIndex] += (pass == 0 ? numTranslations : -1);
-                        }
-                        ++c;
-                    }
-                }
-
-                for (int i : qAsConst(placeMarkerIndexes)) {
-                    if (i != 0) {
-                        if (verbose)
-                            m_errorsView->addError(mi, ErrorsView::PlaceMarkersDiffer);
-                        danger = true;
-                        break;
-                    }
-                }
-
-                // Piggy-backed on the general place markers, we check the plural count marker.
-                if (m->message().isPlural()) {
-                    for (int i = 0; i < numTranslations; ++i)
-                        if (m_dataModel->model(mi)->countRefNeeds().at(i)
-                            && !(translations[i].contains(QLatin1String("%n"))
-                            || translations[i].contains(QLatin1String("%Ln")))) {
-                            if (verbose)
-                                m_errorsView->addError(mi, ErrorsView::NumerusMarkerMissing);
-                            danger = true;
-                            break;
-                        }
-                }
-            }
+            QList<ValidationError> errors;
+            const int failed = validateMessage(checks, source, m->translations(),
+                    m->message().isPlural(),
+                    validationModel(m_dataModel, mi, m_phraseMatchers.at(mi)),
+                    verbose ? &errors : nullptr);
+            m->setCheckResults(checks, failed);
+            for (const ValidationError &error : qAsConst(errors))
+                m_errorsView->addError(mi, error.type, error.arg);
+            danger = failed != 0;
         }
 
         if (danger != m->danger())
@@ -5,6 +5,7 @@
 #define MAINWINDOW_H
 
 #include "phrase.h"
+#include "phrasematcher.h"
 #include "ui_mainwindow.h"
 #include "recentfiles.h"
 #include "messagemodel.h"
@@ -13,9 +14,12 @@
 #include <QtCore/QHash>
 #include <QtCore/QMap>
 #include <QtCore/QLocale>
+#include <QtCore/QSet>
 
 #include <QtWidgets/QMainWindow>
 
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
 class QPixmap;
@@ -29,6 +33,8 @@ class QIcon;
 class QSortFilterProxyModel;
 class QStackedWidget;
 class QTableView;
+class QThread;
+class QTimer;
 class QTreeView;
 
 class BatchTranslationDialog;
@@ -168,6 +174,8 @@ private:
     void updateSourceView(int model, MessageItem *item);
     void updatePhraseBookActions();
     void updatePhraseDictInternal(int model);
+    void phraseBookChanged(PhraseBook *pb);
+    void updateChangedPhraseDicts();
     void releaseInternal(int model);
     void saveInternal(int model);
 
@@ -175,6 +183,11 @@ private:
 
     // FIXME: move to DataModel
     void updateDanger(const MultiDataIndex &index, bool verbose);
+    int enabledChecks() const;
+    void invalidateChecks(int model, int checks);
+    void stopValidation();
+    struct ValidationResult;
+    void applyValidationResults(int generation, const QList<ValidationResult> &results);
 
     bool searchItem(DataModel::FindLocation where, const QString &searchWhat);
 
@@ -195,9 +208,12 @@ private:
     QLabel *m_modifiedLabel;
     FocusWatcher *m_focusWatcher;
     QString m_phraseBookDir;
-    // model : keyword -> list of appropriate phrases in the phrasebooks
-    QList<QHash<QString, QList<Phrase *> > > m_phraseDict;
+    // model : the appropriate phrases in the phrasebooks
+    QList<PhraseMatcher> m_phraseMatchers;
     QList<PhraseBook *> m_phraseBooks;
+    // Phrase books edited since the matchers were last built, see phraseBookChanged()
+    QSet<PhraseBook *> m_changedPhraseBooks;
+    QTimer *m_phraseDictTimer;
     QMap<QAction *, PhraseBook *> m_phraseBookMenu[3];
     QPrinter *m_printer;
 
@@ -229,6 +245,11 @@ private:
 
     Ui::MainWindow m_ui;    // menus and actions
     Statistics *m_statistics;
+
+    // Background validation started by revalidate()
+    QThread *m_validationThread = nullptr;
+    std::atomic<bool> m_validationCanceled{false};
+    int m_validationGeneration = 0;
 };
 
 QT_END_NAMESPACE
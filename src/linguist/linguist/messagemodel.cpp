@@ -2,7 +2,6 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include "messagemodel.h"
-#include "statistics.h"
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
@@ -33,6 +32,18 @@ MessageItem::MessageItem(const TranslatorMessage &message)
 }
 
 
+void MessageItem::translationCounts(int *words, int *chars, int *charsSpaces) const
+{
+    if (m_words < 0) {
+        m_words = m_chars = m_charsSpaces = 0;
+        for (const QString &trnsl : m_message.translations())
+            DataModel::doCharCounting(trnsl, m_words, m_chars, m_charsSpaces);
+    }
+    *words = m_words;
+    *chars = m_chars;
+    *charsSpaces = m_charsSpaces;
+}
+
 bool MessageItem::compare(const QString &findText, bool matchSubstring,
     Qt::CaseSensitivity cs) const
 {
@@ -70,13 +81,19 @@ MessageItem *ContextItem::messageItem(int i) const
     return 0;
 }
 
+void ContextItem::appendMessage(const MessageItem &msg)
+{
+    const QPair<QString, QString> key(msg.text(), msg.comment());
+    if (!m_messageIndex.contains(key))
+        m_messageIndex.insert(key, msgItemList.count());
+    msgItemList.append(msg);
+}
+
 MessageItem *ContextItem::findMessage(const QString &sourcetext, const QString &comment) const
 {
-    for (int i = 0; i < messageCount(); ++i) {
-        MessageItem *mi = messageItem(i);
-        if (mi->text() == sourcetext && mi->comment() == comment)
-            return mi;
-    }
+    const auto it = m_messageIndex.constFind(qMakePair(sourcetext, comment));
+    if (it != m_messageIndex.cend())
+        return messageItem(*it);
     return 0;
 }
 
@@ -121,11 +138,9 @@ MessageItem *DataModel::messageItem(const DataIndex &index) const
 
 ContextItem *DataModel::findContext(const QString &context) const
 {
-    for (int c = 0; c < m_contextList.count(); ++c) {
-        ContextItem *ctx = contextItem(c);
-        if (ctx->context() == context)
-            return ctx;
-    }
+    const auto it = m_contextIndex.constFind(context);
+    if (it != m_contextIndex.cend())
+        return contextItem(*it);
     return 0;
 }
 
@@ -208,21 +223,21 @@ bool DataModel::load(const QString &fileName, bool *langGuessed, QWidget *parent
     m_relativeLocations = (tor.locationsType() == Translator::RelativeLocations);
     m_extra = tor.extras();
     m_contextList.clear();
+    m_contextIndex.clear();
     m_numMessages = 0;
 
-    QHash<QString, int> contexts;
-
     m_srcWords = 0;
     m_srcChars = 0;
     m_srcCharsSpc = 0;
+    m_statsValid = false;
 
     for (const TranslatorMessage &msg : tor.messages()) {
-        if (!contexts.contains(msg.context())) {
-            contexts.insert(msg.context(), m_contextList.size());
+        if (!m_contextIndex.contains(msg.context())) {
+            m_contextIndex.insert(msg.context(), m_contextList.size());
             m_contextList.append(ContextItem(msg.context()));
         }
 
-        ContextItem *c = contextItem(contexts.value(msg.context()));
+        ContextItem *c = contextItem(m_contextIndex.value(msg.context()));
         if (msg.sourceText() == QLatin1String(ContextComment)) {
             c->appendToComment(msg.comment());
         } else {
@@ -402,39 +417,50 @@ void DataModel::setSourceLanguageAndCountry(QLocale::Language lang, QLocale::Cou
 
 void DataModel::updateStatistics()
 {
-    StatisticalData stats {};
-    for (DataModelIterator it(this); it.isValid(); ++it) {
-        const MessageItem *mi = it.current();
-        if (mi->isObsolete()) {
-            stats.obsoleteMsg++;
-        } else if (mi->isFinished()) {
-            bool hasDanger = false;
-            for (const QString &trnsl : mi->translations()) {
-                doCharCounting(trnsl, stats.wordsFinished, stats.charsFinished, stats.charsSpacesFinished);
-                hasDanger |= mi->danger();
-            }
-            if (hasDanger)
-                stats.translatedMsgDanger++;
-            else
-                stats.translatedMsgNoDanger++;
-        } else if (mi->isUnfinished()) {
-            bool hasDanger = false;
-            for (const QString &trnsl : mi->translations()) {
-                doCharCounting(trnsl, stats.wordsUnfinished, stats.charsUnfinished, stats.charsSpacesUnfinished);
-                hasDanger |= mi->danger();
-            }
-            if (hasDanger)
-                stats.unfinishedMsgDanger++;
-            else
-                stats.unfinishedMsgNoDanger++;
-        }
+    if (!m_statsValid) {
+        m_stats = {};
+        for (DataModelIterator it(this); it.isValid(); ++it)
+            countStatistics(*it.current(), 1);
+        m_statsValid = true;
     }
+    StatisticalData stats = m_stats;
     stats.wordsSource = m_srcWords;
     stats.charsSource = m_srcChars;
     stats.charsSpacesSource = m_srcCharsSpc;
     emit statsChanged(stats);
 }
 
+// Adds (sign 1) or removes (sign -1) the message's share of the statistics
+void DataModel::countStatistics(const MessageItem &mi, int sign)
+{
+    if (mi.isObsolete()) {
+        m_stats.obsoleteMsg += sign;
+        return;
+    }
+    int words = 0;
+    int chars = 0;
+    int charsSpaces = 0;
+    mi.translationCounts(&words, &chars, &charsSpaces);
+    const bool hasDanger = mi.danger() && !mi.message().translations().isEmpty();
+    if (mi.isFinished()) {
+        m_stats.wordsFinished += sign * words;
+        m_stats.charsFinished += sign * chars;
+        m_stats.charsSpacesFinished += sign * charsSpaces;
+        if (hasDanger)
+            m_stats.translatedMsgDanger += sign;
+        else
+            m_stats.translatedMsgNoDanger += sign;
+    } else if (mi.isUnfinished()) {
+        m_stats.wordsUnfinished += sign * words;
+        m_stats.charsUnfinished += sign * chars;
+        m_stats.charsSpacesUnfinished += sign * charsSpaces;
+        if (hasDanger)
+            m_stats.unfinishedMsgDanger += sign;
+        else
+            m_stats.unfinishedMsgNoDanger += sign;
+    }
+}
+
 void DataModel::setModified(bool isModified)
 {
     if (m_modified == isModified)
@@ -516,6 +542,7 @@ MultiMessageItem::MultiMessageItem(const MessageItem *m)
 MultiContextItem::MultiContextItem(int oldCount, ContextItem *ctx, bool writable)
     : m_context(ctx->context()),
       m_comment(ctx->comment()),
+      m_indexOk(false),
       m_finishedCount(0),
       m_editableCount(0),
       m_nonobsoleteCount(0)
@@ -584,8 +611,17 @@ void MultiContextItem::appendMessageItems(const QList<MessageItem *> &m)
     for (int i = 0; i < m_messageLists.count() - 1; ++i)
         m_messageLists[i] += nullItems;
     m_messageLists.last() += m;
-    for (MessageItem *mi : m)
+    for (MessageItem *mi : m) {
+        if (m_indexOk) {
+            const int idx = m_multiMessageList.count();
+            const QPair<QString, QString> key(mi->text(), mi->comment());
+            if (!m_messageIndex.contains(key))
+                m_messageIndex.insert(key, idx);
+            if (!m_idIndex.contains(mi->id()))
+                m_idIndex.insert(mi->id(), idx);
+        }
         m_multiMessageList.append(MultiMessageItem(mi));
+    }
 }
 
 void MultiContextItem::removeMultiMessageItem(int pos)
@@ -593,6 +629,22 @@ void MultiContextItem::removeMultiMessageItem(int pos)
     for (int i = 0; i < m_messageLists.count(); ++i)
         m_messageLists[i].removeAt(pos);
     m_multiMessageList.removeAt(pos);
+    m_indexOk = false;
+}
+
+void MultiContextItem::ensureIndexed() const
+{
+    if (m_indexOk)
+        return;
+    m_indexOk = true;
+    m_messageIndex.clear();
+    m_idIndex.clear();
+    // Walk backwards so that earlier messages win.
+    for (int i = m_multiMessageList.count(); --i >= 0;) {
+        const MultiMessageItem &m = m_multiMessageList.at(i);
+        m_messageIndex.insert(qMakePair(m.text(), m.comment()), i);
+        m_idIndex.insert(m.id(), i);
+    }
 }
 
 int MultiContextItem::firstNonobsoleteMessageIndex(int msgIdx) const
@@ -605,22 +657,14 @@ int MultiContextItem::firstNonobsoleteMessageIndex(int msgIdx) const
 
 int MultiContextItem::findMessage(const QString &sourcetext, const QString &comment) const
 {
-    for (int i = 0, cnt = messageCount(); i < cnt; ++i) {
-        MultiMessageItem *m = multiMessageItem(i);
-        if (m->text() == sourcetext && m->comment() == comment)
-            return i;
-    }
-    return -1;
+    ensureIndexed();
+    return m_messageIndex.value(qMakePair(sourcetext, comment), -1);
 }
 
 int MultiContextItem::findMessageById(const QString &id) const
 {
-    for (int i = 0, cnt = messageCount(); i < cnt; ++i) {
-        MultiMessageItem *m = multiMessageItem(i);
-        if (m->id() == id)
-            return i;
-    }
-    return -1;
+    ensureIndexed();
+    return m_idIndex.value(id, -1);
 }
 
 /******************************************************************************
@@ -644,7 +688,8 @@ MultiDataModel::MultiDataModel(QObject *parent) :
     m_numFinished(0),
     m_numEditable(0),
     m_numMessages(0),
-    m_modified(false)
+    m_modified(false),
+    m_contextIndexOk(false)
 {
     for (int i = 0; i < 7; ++i)
         m_colors[i] = QColor(paletteRGBs[i][0], paletteRGBs[i][1], paletteRGBs[i][2]);
@@ -748,6 +793,8 @@ void MultiDataModel::append(DataModel *dm, bool readWrite)
                 m_numMessages += appendItems.size();
             }
         } else {
+            if (m_contextIndexOk)
+                m_contextIndex.insert(c->context(), m_multiContextList.size());
             m_multiContextList << MultiContextItem(modelCount() - 1, c, readWrite);
             m_numMessages += c->messageCount();
             ++appendedContexts;
@@ -800,6 +847,7 @@ void MultiDataModel::close(int model)
             if (!mc.messageCount()) {
                 m_msgModel->beginRemoveRows(QModelIndex(), i, i);
                 m_multiContextList.removeAt(i);
+                m_contextIndexOk = false;
                 m_msgModel->endRemoveRows();
             }
         }
@@ -816,6 +864,8 @@ void MultiDataModel::closeAll()
     qDeleteAll(m_dataModels);
     m_dataModels.clear();
     m_multiContextList.clear();
+    m_contextIndex.clear();
+    m_contextIndexOk = true;
     m_msgModel->endResetModel();
     emit allModelsDeleted();
     onModifiedChanged();
@@ -943,24 +993,26 @@ int MultiDataModel::isFileLoaded(const QString &name) const
     return -1;
 }
 
+void MultiDataModel::ensureContextIndexed() const
+{
+    if (m_contextIndexOk)
+        return;
+    m_contextIndexOk = true;
+    m_contextIndex.clear();
+    for (int i = m_multiContextList.size(); --i >= 0;)
+        m_contextIndex.insert(m_multiContextList.at(i).context(), i);
+}
+
 int MultiDataModel::findContextIndex(const QString &context) const
 {
-    for (int i = 0; i < m_multiContextList.size(); ++i) {
-        const MultiContextItem &mc = m_multiContextList[i];
-        if (mc.context() == context)
-            return i;
-    }
-    return -1;
+    ensureContextIndexed();
+    return m_contextIndex.value(context, -1);
 }
 
 MultiContextItem *MultiDataModel::findContext(const QString &context) const
 {
-    for (int i = 0; i < m_multiContextList.size(); ++i) {
-        const MultiContextItem &mc = m_multiContextList[i];
-        if (mc.context() == context)
-            return const_cast<MultiContextItem *>(&mc);
-    }
-    return 0;
+    int i = findContextIndex(context);
+    return i >= 0 ? multiContextItem(i) : 0;
 }
 
 MessageItem *MultiDataModel::messageItem(const MultiDataIndex &index, int model) const
@@ -980,11 +1032,24 @@ void MultiDataModel::setTranslation(const MultiDataIndex &index, const QString &
     MessageItem *m = messageItem(index);
     if (translation == m->translation())
         return;
+    DataModel *dm = m_dataModels[index.model()];
+    dm->messageAboutToChange(*m);
     m->setTranslation(translation);
+    dm->messageChanged(*m);
     setModified(index.model(), true);
     emit translationChanged(index);
 }
 
+void MultiDataModel::updateTranslations(const MultiDataIndex &index,
+                                        const QStringList &translations)
+{
+    MessageItem *m = messageItem(index);
+    DataModel *dm = m_dataModels[index.model()];
+    dm->messageAboutToChange(*m);
+    m->setTranslations(translations);
+    dm->messageChanged(*m);
+}
+
 void MultiDataModel::setFinished(const MultiDataIndex &index, bool finished)
 {
     MultiContextItem *mc = multiContextItem(index.context());
@@ -993,7 +1058,9 @@ void MultiDataModel::setFinished(const MultiDataIndex &index, bool finished)
     MessageItem *m = messageItem(index);
     TranslatorMessage::Type type = m->type();
     if (type == TranslatorMessage::Unfinished && finished) {
+        m_dataModels[index.model()]->messageAboutToChange(*m);
         m->setType(TranslatorMessage::Finished);
+        m_dataModels[index.model()]->messageChanged(*m);
         mm->decrementUnfinishedCount();
         if (!mm->countUnfinished()) {
             incrementFinishedCount();
@@ -1013,7 +1080,9 @@ void MultiDataModel::setFinished(const MultiDataIndex &index, bool finished)
         emit messageDataChanged(index);
         setModified(index.model(), true);
     } else if (type == TranslatorMessage::Finished && !finished) {
+        m_dataModels[index.model()]->messageAboutToChange(*m);
         m->setType(TranslatorMessage::Unfinished);
+        m_dataModels[index.model()]->messageChanged(*m);
         mm->incrementUnfinishedCount();
         if (mm->countUnfinished() == 1) {
             decrementFinishedCount();
@@ -1050,7 +1119,9 @@ void MultiDataModel::setDanger(const MultiDataIndex &index, bool danger)
                 emit contextDataChanged(index);
         }
         emit messageDataChanged(index);
+        m_dataModels[index.model()]->messageAboutToChange(*m);
         m->setDanger(danger);
+        m_dataModels[index.model()]->messageChanged(*m);
     } else if (m->danger() && !danger) {
         if (m->isFinished()) {
             c->decrementFinishedDangerCount();
@@ -1062,7 +1133,9 @@ void MultiDataModel::setDanger(const MultiDataIndex &index, bool danger)
                 emit contextDataChanged(index);
         }
         emit messageDataChanged(index);
+        m_dataModels[index.model()]->messageAboutToChange(*m);
         m->setDanger(danger);
+        m_dataModels[index.model()]->messageChanged(*m);
     }
 }
 
@@ -10,6 +10,7 @@
 #include <QtCore/QList>
 #include <QtCore/QHash>
 #include <QtCore/QLocale>
+#include <QtCore/QPair>
 #include <QtGui/QColor>
 #include <QtGui/QBitmap>
 
@@ -17,7 +18,24 @@ QT_BEGIN_NAMESPACE
 
 class DataModel;
 class MultiDataModel;
-struct StatisticalData;
+
+struct StatisticalData
+{
+    int wordsSource;
+    int charsSource;
+    int charsSpacesSource;
+    int wordsFinished;
+    int charsFinished;
+    int charsSpacesFinished;
+    int wordsUnfinished;
+    int charsUnfinished;
+    int charsSpacesUnfinished;
+    int translatedMsgNoDanger;
+    int translatedMsgDanger;
+    int obsoleteMsg;
+    int unfinishedMsgNoDanger;
+    int unfinishedMsgDanger;
+};
 
 class MessageItem
 {
@@ -28,7 +46,7 @@ public:
     void setDanger(bool danger) { m_danger = danger; }
 
     void setTranslation(const QString &translation)
-        { m_message.setTranslation(translation); }
+        { m_message.setTranslation(translation); translationsChanged(); }
 
     QString id() const { return m_message.id(); }
     QString context() const { return m_message.context(); }
@@ -43,7 +61,7 @@ public:
     QString translation() const { return m_message.translation(); }
     QStringList translations() const { return m_message.translations(); }
     void setTranslations(const QStringList &translations)
-        { m_message.setTranslations(translations); }
+        { m_message.setTranslations(translations); translationsChanged(); }
 
     TranslatorMessage::Type type() const { return m_message.type(); }
     void setType(TranslatorMessage::Type type) { m_message.setType(type); }
@@ -57,9 +75,37 @@ public:
     bool compare(const QString &findText, bool matchSubstring,
         Qt::CaseSensitivity cs) const;
 
+    // Cached outcome of the validation checks, as bit masks of check types.
+    // The revision changes whenever the results become stale.
+    int revision() const { return m_revision; }
+    int validatedChecks() const { return m_validatedChecks; }
+    int failedChecks() const { return m_failedChecks; }
+    void setCheckResults(int checks, int failed)
+    {
+        m_validatedChecks |= checks;
+        m_failedChecks = (m_failedChecks & ~checks) | (failed & checks);
+    }
+    void invalidateChecks(int checks = ~0)
+    {
+        m_validatedChecks &= ~checks;
+        m_failedChecks &= ~checks;
+        ++m_revision;
+    }
+
+    // Word and character counts of all translations, computed on first use
+    void translationCounts(int *words, int *chars, int *charsSpaces) const;
+
 private:
+    void translationsChanged() { invalidateChecks(); m_words = -1; }
+
     TranslatorMessage m_message;
     bool m_danger;
+    int m_revision = 0;
+    int m_validatedChecks = 0;
+    int m_failedChecks = 0;
+    mutable int m_words = -1;
+    mutable int m_chars = 0;
+    mutable int m_charsSpaces = 0;
 };
 
 
@@ -91,7 +137,7 @@ public:
 private:
     friend class DataModel;
     friend class MultiDataModel;
-    void appendMessage(const MessageItem &msg) { msgItemList.append(msg); }
+    void appendMessage(const MessageItem &msg);
     void appendToComment(const QString &x);
     void incrementFinishedCount() { ++m_finishedCount; }
     void decrementFinishedCount() { --m_finishedCount; }
@@ -108,6 +154,7 @@ private:
     int m_unfinishedDangerCount;
     int m_nonobsoleteCount;
     QList<MessageItem> msgItemList;
+    QHash<QPair<QString, QString>, int> m_messageIndex; // (source text, comment) -> first message
 };
 
 
@@ -186,7 +233,7 @@ public:
     const QList<bool> &countRefNeeds() const { return m_countRefNeeds; }
 
     QStringList normalizedTranslations(const MessageItem &m) const;
-    void doCharCounting(const QString& text, int& trW, int& trC, int& trCS);
+    static void doCharCounting(const QString& text, int& trW, int& trC, int& trCS);
     void updateStatistics();
 
     int getSrcWords() const { return m_srcWords; }
@@ -201,11 +248,18 @@ signals:
 
 private:
     friend class DataModelIterator;
+    friend class MultiDataModel;
     QList<ContextItem> m_contextList;
+    QHash<QString, int> m_contextIndex;
 
     bool save(const QString &fileName, QWidget *parent);
     void updateLocale();
 
+    // Keep the statistics up to date while a message changes
+    void messageAboutToChange(const MessageItem &m) { if (m_statsValid) countStatistics(m, -1); }
+    void messageChanged(const MessageItem &m) { if (m_statsValid) countStatistics(m, 1); }
+    void countStatistics(const MessageItem &m, int sign);
+
     bool m_writable;
     bool m_modified;
 
@@ -215,6 +269,9 @@ private:
     int m_srcWords;
     int m_srcChars;
     int m_srcCharsSpc;
+    // The translation statistics, built on first request and then updated with each change
+    StatisticalData m_stats {};
+    bool m_statsValid = false;
 
     QString m_srcFileName;
     QLocale::Language m_language;
@@ -306,10 +363,15 @@ private:
     void decrementEditableCount() { --m_editableCount; }
     void incrementNonobsoleteCount() { ++m_nonobsoleteCount; }
     void decrementNonobsoleteCount() { --m_nonobsoleteCount; }
+    void ensureIndexed() const;
 
     QString m_context;
     QString m_comment;
     QList<MultiMessageItem> m_multiMessageList;
+    // Lookup of the first multi-message with given contents, built on demand
+    mutable bool m_indexOk;
+    mutable QHash<QPair<QString, QString>, int> m_messageIndex; // (source text, comment)
+    mutable QHash<QString, int> m_idIndex;
     QList<ContextItem *> m_contextList;
     // The next two could be in the MultiMessageItems, but are here for efficiency
     QList<QList<MessageItem *> > m_messageLists;
@@ -397,6 +459,8 @@ public:
 
     // Per message
     void setTranslation(const MultiDataIndex &index, const QString &translation);
+    // Unlike setTranslation(), this does not emit any change notifications
+    void updateTranslations(const MultiDataIndex &index, const QStringList &translations);
     void setFinished(const MultiDataIndex &index, bool finished);
     void setDanger(const MultiDataIndex &index, bool danger);
 
@@ -445,6 +509,7 @@ private:
     void decrementFinishedCount() { --m_numFinished; }
     void incrementEditableCount() { ++m_numEditable; }
     void decrementEditableCount() { --m_numEditable; }
+    void ensureContextIndexed() const;
 
     int m_numFinished;
     int m_numEditable;
@@ -453,6 +518,9 @@ private:
     bool m_modified;
 
     QList<MultiContextItem> m_multiContextList;
+    // Built on demand, as closing a model removes contexts
+    mutable bool m_contextIndexOk;
+    mutable QHash<QString, int> m_contextIndex;
     QList<DataModel *> m_dataModels;
 
     MessageModel *m_msgModel;
@@ -66,8 +66,9 @@ void Phrase::setDefinition(const QString &nd)
     if (d == nd)
         return;
     d = nd;
+    // The definition is not matched against, so nothing else needs updating
     if (m_phraseBook)
-        m_phraseBook->phraseChanged(this);
+        m_phraseBook->setModified(true);
 }
 
 bool operator==(const Phrase &p, const Phrase &q)
@@ -181,6 +182,7 @@ void PhraseBook::setLanguageAndCountry(QLocale::Language lang, QLocale::Country
     m_language = lang;
     m_country = country;
     setModified(true);
+    emit languageChanged();
 }
 
 void PhraseBook::setSourceLanguageAndCountry(QLocale::Language lang, QLocale::Country country)
@@ -295,6 +297,7 @@ void PhraseBook::phraseChanged(Phrase *p)
     Q_UNUSED(p);
 
     setModified(true);
+    emit phraseTextChanged();
 }
 
 QString PhraseBook::friendlyPhraseBookName() const
@@ -77,6 +77,9 @@ public:
 signals:
     void modifiedChanged(bool changed);
     void listChanged();
+    // The source or target of a phrase was edited
+    void phraseTextChanged();
+    void languageChanged();
 
 private:
     // Prevent copying
@@ -0,0 +1,182 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "phrasematcher.h"
+#include "mainwindow.h"
+#include "phrase.h"
+
+#include <QBitArray>
+#include <QStringList>
+
+QT_BEGIN_NAMESPACE
+
+class PhraseMatcherData : public QSharedData
+{
+public:
+    struct Entry
+    {
+        Phrase *phrase;
+        int pattern;
+    };
+
+    int addState()
+    {
+        failure.append(0);
+        match.append(-1);
+        nextMatch.append(0);
+        return failure.size() - 1;
+    }
+
+    static quint64 transitionKey(int state, char16_t ch)
+    {
+        return (quint64(state) << 16) | ch;
+    }
+
+    // keyword -> phrases starting with it, in order of preference
+    QHash<QString, QList<Entry> > keywords;
+    // normalized source -> pattern number
+    QHash<QString, int> patterns;
+    // pattern number -> normalized targets of the phrases with that source
+    QList<QStringList> targets;
+
+    // Aho-Corasick automaton over the normalized sources; state 0 is the root.
+    QHash<quint64, int> transitions;
+    QList<int> failure;
+    QList<int> match;       // the pattern ending in a state, or -1
+    QList<int> nextMatch;   // the closest state on the failure chain that has a match, or 0
+};
+
+PhraseMatcher::PhraseMatcher()
+    : d(new PhraseMatcherData)
+{
+    d->addState();
+}
+
+PhraseMatcher::PhraseMatcher(const QHash<QString, QList<Phrase *> > &phrases)
+    : d(new PhraseMatcherData)
+{
+    QList<QList<QPair<char16_t, int> > > children;
+    d->addState();
+    children.append({});
+
+    for (auto it = phrases.cbegin(), end = phrases.cend(); it != end; ++it) {
+        QList<PhraseMatcherData::Entry> &entries = d->keywords[it.key()];
+        for (Phrase *p : it.value()) {
+            const QString source = MainWindow::friendlyString(p->source());
+            int pattern = d->patterns.value(source, -1);
+            if (pattern < 0) {
+                pattern = d->targets.size();
+                d->patterns.insert(source, pattern);
+                d->targets.append(QStringList());
+
+                int state = 0;
+                for (const QChar c : source) {
+                    const quint64 key = PhraseMatcherData::transitionKey(state, c.unicode());
+                    const auto t = d->transitions.constFind(key);
+                    if (t != d->transitions.cend()) {
+                        state = *t;
+                    } else {
+                        const int next = d->addState();
+                        children.append({});
+                        children[state].append(qMakePair(c.unicode(), next));
+                        d->transitions.insert(key, next);
+                        state = next;
+                    }
+                }
+                d->match[state] = pattern;
+            }
+            d->targets[pattern].append(MainWindow::friendlyString(p->target()));
+            entries.append({ p, pattern });
+        }
+    }
+
+    // Breadth-first, so the failure links of shorter prefixes are known first
+    QList<int> queue;
+    queue.append(0);
+    for (int i = 0; i < queue.size(); ++i) {
+        const int state = queue.at(i);
+        for (const auto &child : qAsConst(children.at(state))) {
+            const int next = child.second;
+            int fail = 0;
+            if (state != 0) {
+                for (int f = d->failure.at(state); ; f = d->failure.at(f)) {
+                    const auto t = d->transitions.constFind(
+                            PhraseMatcherData::transitionKey(f, child.first));
+                    if (t != d->transitions.cend()) {
+                        fail = *t;
+                        break;
+                    }
+                    if (f == 0)
+                        break;
+                }
+            }
+            d->failure[next] = fail;
+            d->nextMatch[next] = d->match.at(fail) >= 0 ? fail : d->nextMatch.at(fail);
+            queue.append(next);
+        }
+    }
+}
+
+PhraseMatcher::PhraseMatcher(const PhraseMatcher &other) = default;
+
+PhraseMatcher &PhraseMatcher::operator=(const PhraseMatcher &other) = default;
+
+PhraseMatcher::~PhraseMatcher() = default;
+
+bool PhraseMatcher::isEmpty() const
+{
+    return d->keywords.isEmpty();
+}
+
+QList<Phrase *> PhraseMatcher::findPhrases(const QString &text) const
+{
+    QList<Phrase *> phrases;
+    if (d->keywords.isEmpty())
+        return phrases;
+
+    QBitArray found(d->targets.size());
+    int state = 0;
+    for (const QChar c : text) {
+        for (;;) {
+            const auto t = d->transitions.constFind(
+                    PhraseMatcherData::transitionKey(state, c.unicode()));
+            if (t != d->transitions.cend()) {
+                state = *t;
+                break;
+            }
+            if (state == 0)
+                break;
+            state = d->failure.at(state);
+        }
+        for (int s = d->match.at(state) >= 0 ? state : d->nextMatch.at(state); s != 0;
+             s = d->nextMatch.at(s)) {
+            found.setBit(d->match.at(s));
+        }
+    }
+
+    const QStringList lookupWords = text.split(QLatin1Char(' '));
+    for (const QString &s : lookupWords) {
+        const auto entries = d->keywords.constFind(s);
+        if (entries == d->keywords.cend())
+            continue;
+        for (const PhraseMatcherData::Entry &e : *entries) {
+            if (found.testBit(e.pattern))
+                phrases.append(e.phrase);
+        }
+    }
+    return phrases;
+}
+
+bool PhraseMatcher::isPhraseIgnored(const QString &source, const QString &translation) const
+{
+    const auto pattern = d->patterns.constFind(source);
+    if (pattern == d->patterns.cend())
+        return false;
+    for (const QString &target : d->targets.at(*pattern)) {
+        if (translation.contains(target))
+            return false;
+    }
+    return true;
+}
+
+QT_END_NAMESPACE
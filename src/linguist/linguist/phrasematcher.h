@@ -0,0 +1,49 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef PHRASEMATCHER_H
+#define PHRASEMATCHER_H
+
+#include <QHash>
+#include <QList>
+#include <QSharedDataPointer>
+#include <QString>
+
+QT_BEGIN_NAMESPACE
+
+class Phrase;
+class PhraseMatcherData;
+
+/*
+  The phrases of the phrase books that apply to one model, compiled for
+  lookup. The phrase texts are normalized once, and the sources are put
+  into an automaton that finds all of them in a text in a single pass.
+
+  A matcher is immutable and implicitly shared, so copies can be handed
+  to other threads. Texts passed in must be normalized with
+  MainWindow::friendlyString().
+*/
+class PhraseMatcher
+{
+public:
+    PhraseMatcher();
+    // keyword -> phrases whose normalized source starts with it, in order of preference
+    explicit PhraseMatcher(const QHash<QString, QList<Phrase *> > &phrases);
+    PhraseMatcher(const PhraseMatcher &other);
+    PhraseMatcher &operator=(const PhraseMatcher &other);
+    ~PhraseMatcher();
+
+    bool isEmpty() const;
+
+    // The phrases occurring in the text, in the order of their keywords in it
+    QList<Phrase *> findPhrases(const QString &text) const;
+    // Whether the source is a phrase none of whose targets occurs in the translation
+    bool isPhraseIgnored(const QString &source, const QString &translation) const;
+
+private:
+    QSharedDataPointer<PhraseMatcherData> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // PHRASEMATCHER_H
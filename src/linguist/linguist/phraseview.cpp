@@ -25,10 +25,10 @@ static QString phraseViewHeaderKey()
     return settingPath("PhraseViewHeader");
 }
 
-PhraseView::PhraseView(MultiDataModel *model, QList<QHash<QString, QList<Phrase *> > > *phraseDict, QWidget *parent)
+PhraseView::PhraseView(MultiDataModel *model, QList<PhraseMatcher> *phraseMatchers, QWidget *parent)
     : QTreeView(parent),
       m_dataModel(model),
-      m_phraseDict(phraseDict),
+      m_phraseMatchers(phraseMatchers),
       m_modelIndex(-1),
       m_doGuesses(true)
 {
@@ -56,6 +56,12 @@ PhraseView::PhraseView(MultiDataModel *model, QList<QHash<QString, QList<Phrase
 
     connect(this, &QAbstractItemView::activated,
             this, &PhraseView::selectPhrase);
+    connect(m_dataModel, &MultiDataModel::modelAppended,
+            this, &PhraseView::invalidateSimilarTextIndex);
+    connect(m_dataModel, &MultiDataModel::modelDeleted,
+            this, &PhraseView::invalidateSimilarTextIndex);
+    connect(m_dataModel, &MultiDataModel::allModelsDeleted,
+            this, &PhraseView::invalidateSimilarTextIndex);
 }
 
 PhraseView::~PhraseView()
@@ -172,47 +178,85 @@ void PhraseView::resetNumGuesses()
     setSourceText(m_modelIndex, m_sourceText);
 }
 
-static CandidateList similarTextHeuristicCandidates(MultiDataModel *model, int mi,
-    const char *text, int maxCandidates)
+void PhraseView::invalidateSimilarTextIndex()
+{
+    m_similarTextModel = nullptr;
+    m_similarTextIndex.clear();
+    m_similarTextItems.clear();
+}
+
+/*
+    The source texts of a model never change once it is loaded, so their
+    co-occurrence matrices are computed once per model and reused for
+    every lookup until models are added or removed.
+*/
+void PhraseView::ensureSimilarTextIndex(int model)
+{
+    const DataModel *dm = m_dataModel->model(model);
+    if (dm == m_similarTextModel)
+        return;
+
+    invalidateSimilarTextIndex();
+    m_similarTextModel = dm;
+    for (MultiDataModelIterator it(m_dataModel, model); it.isValid(); ++it) {
+        if (MessageItem *m = it.current()) {
+            m_similarTextIndex.append(m->text());
+            m_similarTextItems.append(it);
+        }
+    }
+}
+
+CandidateList PhraseView::similarTextHeuristicCandidates(int mi, const char *text,
+                                                         int maxCandidates)
 {
     QList<int> scores;
     CandidateList candidates;
 
     StringSimilarityMatcher stringmatcher(QString::fromLatin1(text));
 
-    for (MultiDataModelIterator it(model, mi); it.isValid(); ++it) {
-        MessageItem *m = it.current();
+    ensureSimilarTextIndex(mi);
+    for (int ti = 0; ti < m_similarTextIndex.size(); ++ti) {
+        // A full list only accepts strictly better scores.
+        const int minScore = candidates.count() == maxCandidates
+                ? scores[maxCandidates - 1] + 1 : textSimilarityThreshold;
+        if (stringmatcher.maxSimilarityScore(m_similarTextIndex, ti) < minScore)
+            continue;
+
+        int score = stringmatcher.getSimilarityScore(m_similarTextIndex, ti);
+        if (score < minScore)
+            continue;
+
+        MultiDataIndex index = m_similarTextItems.at(ti);
+        index.setModel(mi);
+        const MessageItem *m = m_dataModel->messageItem(index);
         if (!m)
             continue;
 
-        TranslatorMessage mtm = m->message();
+        const TranslatorMessage &mtm = m->message();
         if (mtm.type() == TranslatorMessage::Unfinished
             || mtm.translation().isEmpty())
             continue;
 
-        QString s = m->text();
+        if (candidates.count() == maxCandidates) {
+            candidates.removeLast();
+            scores.removeLast();
+        }
 
-        int score = stringmatcher.getSimilarityScore(s);
+        Candidate cand(mtm.context(), m->text(), mtm.comment(), mtm.translation());
 
-        if (candidates.count() == maxCandidates && score > scores[maxCandidates - 1])
-            candidates.removeLast();
-        if (candidates.count() < maxCandidates && score >= textSimilarityThreshold ) {
-            Candidate cand(mtm.context(), s, mtm.comment(), mtm.translation());
-
-            int i;
-            for (i = 0; i < candidates.size(); ++i) {
-                if (score >= scores.at(i)) {
-                    if (score == scores.at(i)) {
-                        if (candidates.at(i) == cand)
-                            goto continue_outer_loop;
-                    } else {
-                        break;
-                    }
+        int i;
+        for (i = 0; i < candidates.size(); ++i) {
+            if (score >= scores.at(i)) {
+                if (score == scores.at(i)) {
+                    if (candidates.at(i) == cand)
+                        goto continue_outer_loop;
+                } else {
+                    break;
                 }
             }
-            scores.insert(i, score);
-            candidates.insert(i, cand);
         }
+        scores.insert(i, score);
+        candidates.insert(i, cand);
         continue_outer_loop:
         ;
     }
@@ -235,7 +279,7 @@ void PhraseView::setSourceText(int model, const QString &sourceText)
         m_phraseModel->addPhrase(p);
 
     if (!sourceText.isEmpty() && m_doGuesses) {
-        const CandidateList cl = similarTextHeuristicCandidates(m_dataModel, model,
+        const CandidateList cl = similarTextHeuristicCandidates(model,
             sourceText.toLatin1(), m_maxCandidates);
         int n = 0;
         for (const Candidate &candidate : cl) {
@@ -256,20 +300,7 @@ void PhraseView::setSourceText(int model, const QString &sourceText)
 
 QList<Phrase *> PhraseView::getPhrases(int model, const QString &source)
 {
-    QList<Phrase *> phrases;
-    const QString f = MainWindow::friendlyString(source);
-    const QStringList lookupWords = f.split(QLatin1Char(' '));
-
-    for (const QString &s : lookupWords) {
-        if (m_phraseDict->at(model).contains(s)) {
-            const auto phraseList = m_phraseDict->at(model).value(s);
-            for (Phrase *p : phraseList) {
-                if (f.contains(MainWindow::friendlyString(p->source())))
-                    phrases.append(p);
-            }
-        }
-    }
-    return phrases;
+    return m_phraseMatchers->at(model).findPhrases(MainWindow::friendlyString(source));
 }
 
 void PhraseView::deleteGuesses()
@@ -6,13 +6,14 @@
 
 #include <QList>
 #include <QTreeView>
+#include "messagemodel.h"
 #include "phrase.h"
+#include "phrasematcher.h"
 
 QT_BEGIN_NAMESPACE
 
 static const int DefaultMaxCandidates = 5;
 
-class MultiDataModel;
 class PhraseModel;
 
 class PhraseView : public QTreeView
@@ -20,7 +21,7 @@ class PhraseView : public QTreeView
     Q_OBJECT
 
 public:
-    PhraseView(MultiDataModel *model, QList<QHash<QString, QList<Phrase *> > > *phraseDict, QWidget *parent = 0);
+    PhraseView(MultiDataModel *model, QList<PhraseMatcher> *phraseMatchers, QWidget *parent = 0);
     ~PhraseView();
     void setSourceText(int model, const QString &sourceText);
 
@@ -55,15 +56,23 @@ private slots:
 private:
     QList<Phrase *> getPhrases(int model, const QString &sourceText);
     void deleteGuesses();
+    CandidateList similarTextHeuristicCandidates(int model, const char *text, int maxCandidates);
+    void ensureSimilarTextIndex(int model);
+    void invalidateSimilarTextIndex();
 
     MultiDataModel *m_dataModel;
-    QList<QHash<QString, QList<Phrase *> > > *m_phraseDict;
+    QList<PhraseMatcher> *m_phraseMatchers;
     QList<Phrase *> m_guesses;
     PhraseModel *m_phraseModel;
     QString m_sourceText;
     int m_modelIndex;
     bool m_doGuesses;
     int m_maxCandidates = DefaultMaxCandidates;
+
+    // Source texts of the messages of one model, for guessing
+    SimilarTextIndex m_similarTextIndex;
+    QList<MultiDataIndex> m_similarTextItems;
+    const DataModel *m_similarTextModel = nullptr;
 };
 
 QT_END_NAMESPACE
@@ -2,11 +2,13 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include <profileutils.h>
+#include <projectdump.h>
 #include <runqttool.h>
 
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qlibraryinfo.h>
+#include <QtCore/qtemporaryfile.h>
 #include <QtCore/qtranslator.h>
 
 #include <iostream>
@@ -81,6 +83,17 @@ int main(int argc, char **argv)
         } else if (!strcmp(argv[i], "-help")) {
             printUsage();
             return 0;
+        } else if (!strcmp(argv[i], "-markuntranslated") || !strcmp(argv[i], "-j")) {
+            // lrelease options taking a value: pass it along rather than
+            // taking it for a project file.
+            if (i + 1 == argc) {
+                printErr(QStringLiteral("The %1 option should be followed by a value.\n")
+                         .arg(QString::fromLocal8Bit(argv[i])));
+                return 1;
+            }
+            lreleaseOptions << QString::fromLocal8Bit(argv[i])
+                            << QString::fromLocal8Bit(argv[i + 1]);
+            ++i;
         } else if (strlen(argv[i]) > 0 && argv[i][0] == '-') {
             lreleaseOptions << QString::fromLocal8Bit(argv[i]);
         } else {
@@ -109,11 +122,22 @@ int main(int argc, char **argv)
     }
 
     lprodumpOptions << proFiles;
-    std::unique_ptr<QTemporaryFile> projectDescription = createProjectDescription(lprodumpOptions);
-    if (keepProjectDescription)
-        projectDescription->setAutoRemove(false);
-    lreleaseOptions << QStringLiteral("-project") << projectDescription->fileName();
-
-    runQtTool(QStringLiteral("lrelease"), lreleaseOptions);
+    const QByteArray projectDescription = createProjectDescription(lprodumpOptions);
+    if (keepProjectDescription) {
+        QTemporaryFile file(QStringLiteral("XXXXXX.json"));
+        file.setAutoRemove(false);
+        if (!file.open() || file.write(projectDescription) != projectDescription.size()) {
+            printErr(QStringLiteral("lrelease-pro: Cannot write project description: %1\n")
+                     .arg(file.errorString()));
+            return 1;
+        }
+        file.close();
+        lreleaseOptions << QStringLiteral("-project") << file.fileName();
+        runQtTool(QStringLiteral("lrelease"), lreleaseOptions);
+    } else {
+        // Hand the description over in memory
+        lreleaseOptions << QStringLiteral("-project") << QStringLiteral("-");
+        runQtTool(QStringLiteral("lrelease"), lreleaseOptions, projectDescription);
+    }
     return 0;
 }
@@ -11,6 +11,7 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QTranslator>
 #endif
+#include <QtCore/QBuffer>
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
@@ -18,20 +19,51 @@
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtCore/QTextStream>
+#include <QtCore/QThread>
 #include <QtCore/QLibraryInfo>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
 QT_USE_NAMESPACE
 
 using namespace Qt::StringLiterals;
 
+// Output of a job running on a worker thread, printed once the jobs before it are done.
+struct JobOutput
+{
+    struct Chunk
+    {
+        bool isError;
+        QString text;
+    };
+    QList<Chunk> chunks;
+};
+
+static thread_local JobOutput *jobOutput = nullptr;
+
 static void printOut(const QString & out)
 {
+    if (jobOutput) {
+        jobOutput->chunks.append({ false, out });
+        return;
+    }
     QTextStream stream(stdout);
     stream << out;
 }
 
 static void printErr(const QString & out)
 {
+    if (jobOutput) {
+        jobOutput->chunks.append({ true, out });
+        return;
+    }
     QTextStream stream(stderr);
     stream << out;
 }
@@ -67,8 +99,12 @@ Options:
     -project <filename>
            Name of a file containing the project's description in JSON format.
            Such a file may be generated from a .pro file using the lprodump tool.
+           Use - to read it from the standard input.
     -silent
            Do not explain what is being done
+    -j <n>
+           Release up to n TS files in parallel. 0 uses one job per
+           processor. Has no effect together with -qm.
     -version
            Display the version of lrelease and exit
 )"_s);
@@ -88,10 +124,16 @@ static bool loadTsFile(Translator &tor, const QString &tsFileName, bool /* verbo
     return ok;
 }
 
+// Decides whether a released file may be written, see releaseTsFiles().
+typedef std::function<bool()> WriteGate;
+
 static bool releaseTranslator(Translator &tor, const QString &qmFileName,
-    ConversionData &cd, bool removeIdentical)
+    ConversionData &cd, bool removeIdentical, const WriteGate &mayWrite = WriteGate())
 {
-    tor.reportDuplicates(tor.resolveDuplicates(), qmFileName, cd.isVerbose());
+    std::ostringstream duplicates;
+    tor.reportDuplicates(tor.resolveDuplicates(), qmFileName, cd.isVerbose(), duplicates);
+    if (!duplicates.str().empty())
+        printErr(QString::fromLocal8Bit(duplicates.str()));
 
     if (cd.isVerbose())
         printOut(QLatin1String("Updating '%1'...\n").arg(qmFileName));
@@ -102,28 +144,49 @@ static bool releaseTranslator(Translator &tor, const QString &qmFileName,
         tor.stripIdenticalSourceTranslations();
     }
 
-    QFile file(qmFileName);
-    if (!file.open(QIODevice::WriteOnly)) {
-        printErr(QLatin1String("lrelease error: cannot create '%1': %2\n")
-                         .arg(qmFileName, file.errorString()));
-        return false;
-    }
-
+    // Generate the QM data in memory first, so that a file whose contents
+    // would not change is left alone and keeps its modification time.
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
     tor.normalizeTranslations(cd);
-    bool ok = saveQM(tor, file, cd);
-    file.close();
+    bool ok = saveQM(tor, buffer, cd);
+    buffer.close();
 
     if (!ok) {
         printErr(QLatin1String("lrelease error: cannot save '%1': %2").arg(qmFileName, cd.error()));
-    } else if (!cd.errors().isEmpty()) {
-        printOut(cd.error());
+        cd.clearErrors();
+        return false;
+    }
+
+    if (mayWrite && !mayWrite())
+        return false;
+
+    QFile file(qmFileName);
+    if (!file.open(QIODevice::ReadOnly) || file.readAll() != buffer.data()) {
+        file.close();
+        if (!file.open(QIODevice::WriteOnly)) {
+            printErr(QLatin1String("lrelease error: cannot create '%1': %2\n")
+                             .arg(qmFileName, file.errorString()));
+            cd.clearErrors();
+            return false;
+        }
+        if (file.write(buffer.data()) != buffer.data().size() || !file.flush()) {
+            printErr(QLatin1String("lrelease error: cannot save '%1': %2\n")
+                             .arg(qmFileName, file.errorString()));
+            cd.clearErrors();
+            return false;
+        }
+        file.close();
     }
+
+    if (!cd.errors().isEmpty())
+        printOut(cd.error());
     cd.clearErrors();
-    return ok;
+    return true;
 }
 
 static bool releaseTsFile(const QString& tsFileName,
-    ConversionData &cd, bool removeIdentical)
+    ConversionData &cd, bool removeIdentical, const WriteGate &mayWrite = WriteGate())
 {
     Translator tor;
     if (!loadTsFile(tor, tsFileName, cd.isVerbose()))
@@ -138,7 +201,78 @@ static bool releaseTsFile(const QString& tsFileName,
     }
     qmFileName += QLatin1String(".qm");
 
-    return releaseTranslator(tor, qmFileName, cd, removeIdentical);
+    return releaseTranslator(tor, qmFileName, cd, removeIdentical, mayWrite);
+}
+
+/*
+  Releases the TS files on up to \a jobCount threads. Messages are printed in
+  the order of \a tsFileNames. The QM files are generated in parallel, but
+  written in that order, and none is written after one failed, so the output,
+  the files and the result are those of releasing the files one by one.
+*/
+static bool releaseTsFiles(const QStringList &tsFileNames, const ConversionData &cd,
+                           bool removeIdentical, int jobCount)
+{
+    struct Job
+    {
+        JobOutput output;
+        bool ok = false;
+    };
+    const int count = tsFileNames.size();
+    std::vector<Job> jobs(count);
+    std::atomic<int> nextJob(0);
+    std::mutex mutex;
+    std::condition_variable written;
+    int writtenCount = 0; // The files before this one are written
+    int firstFailure = count;
+
+    const auto work = [&] {
+        for (int i = nextJob++; i < count; i = nextJob++) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (firstFailure < i)
+                    break;
+            }
+            // Jobs are started in order, so the ones waited for are running already.
+            const auto mayWrite = [&, i] {
+                std::unique_lock<std::mutex> lock(mutex);
+                written.wait(lock, [&] { return writtenCount == i || firstFailure < i; });
+                return firstFailure > i;
+            };
+            ConversionData jobCd = cd;
+            jobOutput = &jobs[i].output;
+            jobs[i].ok = releaseTsFile(tsFileNames.at(i), jobCd, removeIdentical, mayWrite);
+            jobOutput = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (jobs[i].ok)
+                    writtenCount = i + 1;
+                else
+                    firstFailure = std::min(firstFailure, i);
+            }
+            written.notify_all();
+        }
+    };
+
+    if (jobCount == 0)
+        jobCount = QThread::idealThreadCount();
+    std::vector<std::thread> threads;
+    for (int i = std::min(jobCount, count); i > 0; --i)
+        threads.emplace_back(work);
+    for (std::thread &thread : threads)
+        thread.join();
+
+    for (const Job &job : jobs) {
+        for (const JobOutput::Chunk &chunk : job.output.chunks) {
+            if (chunk.isError)
+                printErr(chunk.text);
+            else
+                printOut(chunk.text);
+        }
+        if (!job.ok)
+            return false;
+    }
+    return true;
 }
 
 static QStringList translationsFromProjects(const Projects &projects, bool topLevel);
@@ -172,6 +306,7 @@ int main(int argc, char **argv)
     ConversionData cd;
     cd.m_verbose = true; // the default is true starting with Qt 4.2
     bool removeIdentical = false;
+    int jobCount = 1;
     Translator tor;
     QStringList inputFiles;
     QString outputFile;
@@ -209,6 +344,17 @@ int main(int argc, char **argv)
                 return 1;
             }
             projectDescriptionFile = QString::fromLocal8Bit(argv[++i]);
+        } else if (!strcmp(argv[i], "-j")) {
+            if (i == argc - 1) {
+                printUsage();
+                return 1;
+            }
+            bool ok;
+            jobCount = QString::fromLocal8Bit(argv[++i]).toInt(&ok);
+            if (!ok || jobCount < 0) {
+                printErr(QLatin1String("lrelease error: -j expects a non-negative number.\n"));
+                return 1;
+            }
         } else if (!strcmp(argv[i], "-silent")) {
             cd.m_verbose = false;
             continue;
@@ -260,6 +406,9 @@ int main(int argc, char **argv)
         inputFiles = translationsFromProjects(projectDescription);
     }
 
+    if (outputFile.isEmpty() && jobCount != 1 && inputFiles.size() > 1)
+        return releaseTsFiles(inputFiles, cd, removeIdentical, jobCount) ? 0 : 1;
+
     for (const QString &inputFile : qAsConst(inputFiles)) {
         if (outputFile.isEmpty()) {
             if (!releaseTsFile(inputFile, cd, removeIdentical))
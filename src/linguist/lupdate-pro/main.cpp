@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include <profileutils.h>
+#include <projectdump.h>
 #include <runqttool.h>
 
 #include <QtCore/qcoreapplication.h>
@@ -123,11 +124,22 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    std::unique_ptr<QTemporaryFile> projectDescription = createProjectDescription(lprodumpOptions);
-    if (keepProjectDescription)
-        projectDescription->setAutoRemove(false);
-    lupdateOptions << QStringLiteral("-project") << projectDescription->fileName();
-
-    runQtTool(QStringLiteral("lupdate"), lupdateOptions);
+    const QByteArray projectDescription = createProjectDescription(lprodumpOptions);
+    if (keepProjectDescription) {
+        QTemporaryFile file(QStringLiteral("XXXXXX.json"));
+        file.setAutoRemove(false);
+        if (!file.open() || file.write(projectDescription) != projectDescription.size()) {
+            printErr(QStringLiteral("lupdate-pro: Cannot write project description: %1\n")
+                     .arg(file.errorString()));
+            return 1;
+        }
+        file.close();
+        lupdateOptions << QStringLiteral("-project") << file.fileName();
+        runQtTool(QStringLiteral("lupdate"), lupdateOptions);
+    } else {
+        // Hand the description over in memory
+        lupdateOptions << QStringLiteral("-project") << QStringLiteral("-");
+        runQtTool(QStringLiteral("lupdate"), lupdateOptions, projectDescription);
+    }
     return 0;
 }
@@ -715,13 +715,10 @@ void LupdateVisitor::setInfoFromRawComment(const QString &commentString,
     }
 }
 
-void LupdateVisitor::processPreprocessorCalls()
+void LupdateVisitor::processPreprocessorCalls(const TranslationStores &ppStores)
 {
-    QString inputFile = toQt(m_inputFile);
-    for (const auto &store : m_stores->Preprocessor) {
-        if (store.lupdateInputFile == inputFile)
-            processPreprocessorCall(store);
-    }
+    for (const auto &store : ppStores)
+        processPreprocessorCall(store);
 
     if (m_qDeclareTrMacroAll.size() > 0 || m_noopTranslationMacroAll.size() > 0)
         m_macro = true;
@@ -5,6 +5,8 @@
 #define CLANG_TOOL_AST_READER_H
 
 #include "cpp_clang.h"
+#include "lupdatepreprocessoraction.h"
+
 #if defined(Q_CC_MSVC)
 # pragma warning(push)
 # pragma warning(disable: 4100)
@@ -35,13 +37,10 @@ public:
     explicit LupdateVisitor(clang::ASTContext *context, Stores *stores)
         : m_context(context)
         , m_stores(stores)
-    {
-        m_inputFile = m_context->getSourceManager().getFileEntryForID(
-            m_context->getSourceManager().getMainFileID())->getName();
-    }
+    {}
 
     bool VisitCallExpr(clang::CallExpr *callExpression);
-    void processPreprocessorCalls();
+    void processPreprocessorCalls(const TranslationStores &ppStores);
     bool VisitNamedDecl(clang::NamedDecl *namedDeclaration);
     void findContextForTranslationStoresFromPP(clang::NamedDecl *namedDeclaration);
     void generateOutput();
@@ -57,7 +56,6 @@ private:
     void processIsolatedComments(const clang::FileID file);
 
     clang::ASTContext *m_context = nullptr;
-    std::string m_inputFile;
 
     Stores *m_stores = nullptr;
 
@@ -70,15 +68,17 @@ private:
 class LupdateASTConsumer : public clang::ASTConsumer
 {
 public:
-    explicit LupdateASTConsumer(clang::ASTContext *context, Stores *stores)
+    explicit LupdateASTConsumer(clang::ASTContext *context, Stores *stores,
+                                const TranslationStores *ppStores)
         : m_visitor(context, stores)
+        , m_ppStores(ppStores)
     {}
 
     // This method is called when the ASTs for entire translation unit have been
     // parsed.
     void HandleTranslationUnit(clang::ASTContext &context) override
     {
-        m_visitor.processPreprocessorCalls();
+        m_visitor.processPreprocessorCalls(*m_ppStores);
         bool traverse = m_visitor.TraverseAST(context);
         qCDebug(lcClang) << "TraverseAST: " << traverse;
         m_visitor.generateOutput();
@@ -86,6 +86,7 @@ public:
 
 private:
     LupdateVisitor m_visitor;
+    const TranslationStores *m_ppStores = nullptr;
 };
 
 class LupdateFrontendAction : public clang::ASTFrontendAction
@@ -95,15 +96,26 @@ public:
         : m_stores(stores)
     {}
 
+    // The preprocessor callbacks and the AST consumer share one compile of
+    // the translation unit; the callbacks have seen the whole file by the
+    // time HandleTranslationUnit() runs. A missing include is a fatal error
+    // after which clang stops expanding #includes, so it is suppressed here
+    // and reported by the callbacks.
     std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(
         clang::CompilerInstance &compiler, llvm::StringRef /* inFile */) override
     {
-        auto consumer = new LupdateASTConsumer(&compiler.getASTContext(), m_stores);
+        auto &preprocessor = compiler.getPreprocessor();
+        preprocessor.SetSuppressIncludeNotFoundError(true);
+        auto callbacks = new LupdatePPCallbacks(&m_ppStores, preprocessor);
+        preprocessor.addPPCallbacks(std::unique_ptr<clang::PPCallbacks>(callbacks));
+
+        auto consumer = new LupdateASTConsumer(&compiler.getASTContext(), m_stores, &m_ppStores);
         return std::unique_ptr<clang::ASTConsumer>(consumer);
     }
 
 private:
     Stores *m_stores = nullptr;
+    TranslationStores m_ppStores;
 };
 
 class LupdateToolActionFactory : public clang::tooling::FrontendActionFactory
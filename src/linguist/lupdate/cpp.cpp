@@ -2,13 +2,23 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include "cpp.h"
+#include "extractioncache.h"
 
 #include <translator.h>
 #include <QtCore/QBitArray>
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QStack>
 #include <QtCore/QTextStream>
+#include <QtCore/QThread>
 #include <QtCore/QRegularExpression>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 
@@ -22,25 +32,24 @@ static QString MagicComment(QLatin1String("TRANSLATOR"));
 
 size_t qHash(const HashString &str)
 {
-    if (str.m_hash & 0x80000000)
-        str.m_hash = qHash(str.m_str) & 0x7fffffff;
     return str.m_hash;
 }
 
-size_t qHash(const HashStringList &list)
+HashStringList::HashStringList(const QList<HashString> &list)
+    : m_list(list), m_hash(0)
 {
-    if (list.m_hash & 0x80000000) {
-        uint hash = 0;
-        for (const HashString &qs : list.m_list) {
-            hash ^= qHash(qs) ^ 0x6ad9f526;
-            hash = ((hash << 13) & 0x7fffffff) | (hash >> 18);
-        }
-        list.m_hash = hash;
+    for (const HashString &qs : list) {
+        m_hash ^= qs.m_hash ^ 0x6ad9f526;
+        m_hash = ((m_hash << 13) & 0x7fffffff) | (m_hash >> 18);
     }
+}
+
+size_t qHash(const HashStringList &list)
+{
     return list.m_hash;
 }
 
-static int nextFileId;
+static std::atomic<int> nextFileId;
 
 class VisitRecorder {
 public:
@@ -81,10 +90,15 @@ public:
     void setInput(const QString &in);
     void setInput(QTextStream &ts, const QString &fileName);
     void setTranslator(Translator *_tor) { tor = _tor; }
+    void setMessageStream(std::ostream *stream) { yyMsgStream = stream; }
     void parse(ConversionData &cd, const QStringList &includeStack, QSet<QString> &inclusions);
     void parseInternal(ConversionData &cd, const QStringList &includeStack, QSet<QString> &inclusions);
+    void parseInclude(ConversionData &cd, const QString &file);
     const ParseResults *recordResults(bool isHeader);
     void deleteResults() { delete results; }
+    const QSet<QString> &dependencies() const { return readFiles; }
+    const QSet<QString> &directIncludes() const { return blacklisted; }
+    const QList<MissingTrFunctions> &missingTrFunctions() const { return missingTr; }
 
 private:
     struct IfdefState {
@@ -117,6 +131,8 @@ private:
     std::ostream &yyMsg(int line = 0);
 
     int getChar();
+    bool scanBlockComment();
+    bool scanLineComment();
     TokenType lookAheadToSemicolonOrLeftBrace();
     TokenType getToken();
 
@@ -137,6 +153,8 @@ private:
     void handleTranslate(bool plural);
     void handleTrId(bool plural);
     void handleDeclareTrFunctions();
+    void addMissingTrFunctions(const QList<MissingTrFunctions> &missing);
+    void complainMissingTrFunctions(const Namespace *classDef, const QString &context);
 
     void processInclude(const QString &file, ConversionData &cd,
                         const QStringList &includeStack, QSet<QString> &inclusions);
@@ -178,6 +196,7 @@ private:
 
     // Tokenizer state
     QString yyFileName;
+    std::ostream *yyMsgStream = &std::cerr;
     int yyCh;
     bool yyAtNewline;
     QString yyWord;
@@ -196,6 +215,7 @@ private:
     QStringConverter::Encoding yySourceEncoding = QStringConverter::Utf8;
     QString yyInStr;
     const ushort *yyInPtr;
+    const ushort *yyInEnd; // the first NUL, where getChar() stops
 
     // Parser state
     TokenType yyTok;
@@ -214,6 +234,23 @@ private:
     Translator *tor;
     bool directInclude;
 
+    // Files read while parsing this one, including the places where an
+    // #include was looked for in vain, and files whose messages were thereby
+    // taken over.
+    QSet<QString> readFiles;
+    QSet<QString> blacklisted;
+    // Reported once all files are parsed, in their order; see loadCPP().
+    QList<MissingTrFunctions> missingTr;
+
+    // The parse results of other files are shared with other threads, so
+    // their delayed namespace aliases are resolved into this cache instead
+    // of in place.
+    struct ResolvedAlias {
+        NamespaceList alias;
+        NamespaceList resolved; // empty if the alias cannot be resolved
+    };
+    mutable QHash<const Namespace *, QHash<HashString, ResolvedAlias>> resolvedAliases;
+
     CppParserState savedState;
     int yyMinBraceDepth;
     bool inDefine;
@@ -244,7 +281,7 @@ CppParser::CppParser(ParseResults *_results)
 
 std::ostream &CppParser::yyMsg(int line)
 {
-    return std::cerr << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
+    return *yyMsgStream << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
 }
 
 void CppParser::setInput(const QString &in)
@@ -325,6 +362,56 @@ int CppParser::getChar()
     }
 }
 
+/*
+  Comments make up a large part of typical sources, and are mostly irrelevant.
+  Instead of feeding them through getChar() one character at a time, these
+  locate the end of the comment with the vectorized search of QStringView
+  and copy the comment into yyWord in one go.
+
+  getChar() folds line continuations and carriage returns, so the fast paths
+  give up if there are any, and the caller falls back to reading characters.
+*/
+bool CppParser::scanBlockComment()
+{
+    const QStringView rest(yyInPtr, yyInEnd);
+    const qsizetype end = rest.indexOf(u"*/");
+    if (end < 0)
+        return false;
+    const QStringView comment = rest.first(end);
+    if (comment.contains(u'\r') || comment.contains(u"\\\n"))
+        return false;
+
+    memcpy((ushort *)yyWord.unicode(), comment.utf16(), end * sizeof(ushort));
+    yyWord.resize(end);
+    yyCurLineNo += comment.count(u'\n');
+    yyAtNewline = false;
+    yyInPtr += end + 2;
+    return true;
+}
+
+bool CppParser::scanLineComment()
+{
+    const QStringView rest(yyInPtr, yyInEnd);
+    const qsizetype end = rest.indexOf(u'\n');
+    if (end < 0)
+        return false;
+    QStringView comment = rest.first(end);
+    if (comment.endsWith(u'\r'))
+        comment.chop(1);
+    if (comment.endsWith(u'\\') || comment.contains(u'\r'))
+        return false;
+
+    ushort *ptr = (ushort *)yyWord.unicode();
+    memcpy(ptr, comment.utf16(), comment.size() * sizeof(ushort));
+    ptr[comment.size()] = '\n';
+    yyWord.resize(comment.size() + 1);
+    ++yyCurLineNo;
+    yyAtNewline = true;
+    yyInPtr += end + 1;
+    yyCh = '\n';
+    return true;
+}
+
 CppParser::TokenType CppParser::lookAheadToSemicolonOrLeftBrace()
 {
     if (*yyInPtr == 0)
@@ -704,6 +791,10 @@ CppParser::TokenType CppParser::getToken()
             case '/':
                 yyCh = getChar();
                 if (yyCh == '/') {
+                    if (scanLineComment()) {
+                        processComment();
+                        break;
+                    }
                     ushort *ptr = (ushort *)yyWord.unicode();
                     do {
                         yyCh = getChar();
@@ -714,6 +805,11 @@ CppParser::TokenType CppParser::getToken()
                     yyWord.resize(ptr - (ushort *)yyWord.unicode());
                     processComment();
                 } else if (yyCh == '*') {
+                    if (scanBlockComment()) {
+                        processComment();
+                        yyCh = getChar();
+                        break;
+                    }
                     bool metAster = false;
                     ushort *ptr = (ushort *)yyWord.unicode();
 
@@ -998,14 +1094,23 @@ bool CppParser::qualifyOneCallbackOwn(const Namespace *ns, void *context) const
     if (nsai != ns->aliases.constEnd()) {
         const NamespaceList &nsl = *nsai;
         if (nsl.last().value().isEmpty()) { // Delayed alias resolution
-            NamespaceList &nslIn = *const_cast<NamespaceList *>(&nsl);
-            nslIn.removeLast();
-            NamespaceList nslOut;
-            if (!fullyQualify(data->namespaces, data->nsCount, nslIn, false, &nslOut, 0)) {
-                const_cast<Namespace *>(ns)->aliases.remove(data->segment);
-                return false;
+            ResolvedAlias &alias = resolvedAliases[ns][data->segment];
+            if (alias.alias != nsl) {
+                alias.alias = nsl;
+                NamespaceList nslIn = nsl;
+                nslIn.removeLast();
+                // An alias referring to itself resolves to its unresolved target
+                alias.resolved = nslIn;
+                NamespaceList nslOut;
+                if (!fullyQualify(data->namespaces, data->nsCount, nslIn, false, &nslOut, 0))
+                    nslOut.clear();
+                resolvedAliases[ns][data->segment].resolved = nslOut;
             }
-            nslIn = nslOut;
+            const NamespaceList &resolved = resolvedAliases[ns][data->segment].resolved;
+            if (resolved.isEmpty())
+                return false;
+            *data->resolved = resolved;
+            return true;
         }
         *data->resolved = nsl;
         return true;
@@ -1147,6 +1252,20 @@ bool CppParser::isInClassDeclaration() const
   Functions for processing include files.
 */
 
+QMutex &CppFiles::mutex()
+{
+    static QMutex mutex;
+
+    return mutex;
+}
+
+QWaitCondition &CppFiles::resultsAvailable()
+{
+    static QWaitCondition condition;
+
+    return condition;
+}
+
 IncludeCycleHash &CppFiles::includeCycles()
 {
     static IncludeCycleHash cycles;
@@ -1168,8 +1287,47 @@ QSet<QString> &CppFiles::blacklistedFiles()
     return blacklisted;
 }
 
+// The files loadCPP() was asked for. Parsing them always yields messages.
+QSet<QString> &CppFiles::sourceFiles()
+{
+    static QSet<QString> sources;
+
+    return sources;
+}
+
+QHash<QString, QSet<QString>> &CppFiles::fileDependencies()
+{
+    static QHash<QString, QSet<QString>> dependencies;
+
+    return dependencies;
+}
+
+QHash<QString, QList<MissingTrFunctions>> &CppFiles::fileMissingTrFunctions()
+{
+    static QHash<QString, QList<MissingTrFunctions>> missing;
+
+    return missing;
+}
+
+// Headers currently being parsed, and the thread doing it.
+QHash<QString, Qt::HANDLE> &CppFiles::claimedFiles()
+{
+    static QHash<QString, Qt::HANDLE> claimed;
+
+    return claimed;
+}
+
+// Threads waiting for another thread to finish parsing a header.
+QHash<Qt::HANDLE, QString> &CppFiles::waitingThreads()
+{
+    static QHash<Qt::HANDLE, QString> waiting;
+
+    return waiting;
+}
+
 QSet<const ParseResults *> CppFiles::getResults(const QString &cleanFile)
 {
+    QMutexLocker locker(&mutex());
     IncludeCycle * const cycle = includeCycles().value(cleanFile);
 
     if (cycle)
@@ -1178,8 +1336,62 @@ QSet<const ParseResults *> CppFiles::getResults(const QString &cleanFile)
         return QSet<const ParseResults *>();
 }
 
+/*
+  Returns the results for \a cleanFile, waiting for them if another thread is
+  parsing the file already. If there are none yet, \a claimed is set and the
+  calling thread is expected to provide them via setResults(), or to give up
+  with releaseClaim().
+
+  If waiting would deadlock because the other thread (transitively) waits for
+  this one, nothing is returned and \a claimed is not set. This needs an
+  include cycle spanning threads, and loadCPP() parses the headers of all
+  include cycles before it starts any threads.
+*/
+QSet<const ParseResults *> CppFiles::claimResults(const QString &cleanFile, bool *claimed)
+{
+    const Qt::HANDLE self = QThread::currentThreadId();
+    QMutexLocker locker(&mutex());
+    *claimed = false;
+    forever {
+        IncludeCycle * const cycle = includeCycles().value(cleanFile);
+        if (cycle && !cycle->results.isEmpty())
+            return cycle->results;
+
+        const auto owner = claimedFiles().constFind(cleanFile);
+        if (owner == claimedFiles().cend()) {
+            claimedFiles().insert(cleanFile, self);
+            *claimed = true;
+            return QSet<const ParseResults *>();
+        }
+
+        for (Qt::HANDLE thread = *owner; thread; ) {
+            if (thread == self)
+                return QSet<const ParseResults *>();
+            const auto waitsFor = waitingThreads().constFind(thread);
+            if (waitsFor == waitingThreads().cend())
+                break;
+            thread = claimedFiles().value(*waitsFor);
+        }
+
+        waitingThreads().insert(self, cleanFile);
+        resultsAvailable().wait(&mutex());
+        waitingThreads().remove(self);
+    }
+}
+
+void CppFiles::releaseClaim(const QString &cleanFile)
+{
+    QMutexLocker locker(&mutex());
+    const auto it = claimedFiles().find(cleanFile);
+    if (it != claimedFiles().end() && *it == QThread::currentThreadId()) {
+        claimedFiles().erase(it);
+        resultsAvailable().wakeAll();
+    }
+}
+
 void CppFiles::setResults(const QString &cleanFile, const ParseResults *results)
 {
+    QMutexLocker locker(&mutex());
     IncludeCycle *cycle = includeCycles().value(cleanFile);
 
     if (!cycle) {
@@ -1189,30 +1401,52 @@ void CppFiles::setResults(const QString &cleanFile, const ParseResults *results)
 
     cycle->fileNames.insert(cleanFile);
     cycle->results.insert(results);
+
+    const auto it = claimedFiles().find(cleanFile);
+    if (it != claimedFiles().end() && *it == QThread::currentThreadId())
+        claimedFiles().erase(it);
+    resultsAvailable().wakeAll();
 }
 
 const Translator *CppFiles::getTranslator(const QString &cleanFile)
 {
+    QMutexLocker locker(&mutex());
     return translatedFiles().value(cleanFile);
 }
 
 void CppFiles::setTranslator(const QString &cleanFile, const Translator *tor)
 {
+    QMutexLocker locker(&mutex());
     translatedFiles().insert(cleanFile, tor);
 }
 
 bool CppFiles::isBlacklisted(const QString &cleanFile)
 {
+    QMutexLocker locker(&mutex());
     return blacklistedFiles().contains(cleanFile);
 }
 
 void CppFiles::setBlacklisted(const QString &cleanFile)
 {
+    QMutexLocker locker(&mutex());
     blacklistedFiles().insert(cleanFile);
 }
 
+bool CppFiles::isSourceFile(const QString &cleanFile)
+{
+    QMutexLocker locker(&mutex());
+    return sourceFiles().contains(cleanFile);
+}
+
+void CppFiles::setSourceFiles(const QStringList &cleanFiles)
+{
+    QMutexLocker locker(&mutex());
+    sourceFiles() = QSet<QString>(cleanFiles.cbegin(), cleanFiles.cend());
+}
+
 void CppFiles::addIncludeCycle(const QSet<QString> &fileNames)
 {
+    QMutexLocker locker(&mutex());
     IncludeCycle * const cycle = new IncludeCycle;
     cycle->fileNames = fileNames;
 
@@ -1233,22 +1467,82 @@ void CppFiles::addIncludeCycle(const QSet<QString> &fileNames)
         includeCycles().insert(fileName, cycle);
 }
 
+QSet<QString> CppFiles::getDependencies(const QString &cleanFile)
+{
+    QMutexLocker locker(&mutex());
+    return fileDependencies().value(cleanFile);
+}
+
+void CppFiles::setDependencies(const QString &cleanFile, const QSet<QString> &dependencies)
+{
+    QMutexLocker locker(&mutex());
+    fileDependencies().insert(cleanFile, dependencies);
+}
+
+QList<MissingTrFunctions> CppFiles::getMissingTrFunctions(const QString &cleanFile)
+{
+    QMutexLocker locker(&mutex());
+    return fileMissingTrFunctions().value(cleanFile);
+}
+
+void CppFiles::setMissingTrFunctions(const QString &cleanFile,
+                                     const QList<MissingTrFunctions> &missing)
+{
+    QMutexLocker locker(&mutex());
+    fileMissingTrFunctions().insert(cleanFile, missing);
+}
+
 static bool isHeader(const QString &name)
 {
     QString fileExt = QFileInfo(name).suffix();
     return fileExt.isEmpty() || fileExt.startsWith(QLatin1Char('h'), Qt::CaseInsensitive);
 }
 
+static bool isExcluded(const QString &cleanFile, const ConversionData &cd)
+{
+    for (const QString &ex : cd.m_excludes) {
+        QRegularExpression rx(QRegularExpression::wildcardToRegularExpression(ex));
+        if (rx.match(cleanFile).hasMatch())
+            return true;
+    }
+    return false;
+}
+
+/*
+  Finds the files an #include of \a name in \a includer refers to. The
+  candidates which do not exist are added to \a misses, as creating one of
+  them would change the result.
+*/
+static QStringList resolveInclude(const QString &includer, const QString &name, bool quoted,
+                                  const ConversionData &cd, QSet<QString> *misses = nullptr)
+{
+    if (quoted) {
+        const QString file = QDir(QFileInfo(includer).absolutePath()).absoluteFilePath(name);
+        if (QFileInfo(file).isFile())
+            return QStringList(file);
+        if (misses)
+            misses->insert(QDir::cleanPath(file));
+    }
+    const QStringList cSources = cd.m_allCSources.values(name);
+    if (!cSources.isEmpty())
+        return cSources;
+    for (const QString &incPath : cd.m_includePath) {
+        const QString file = QDir(incPath).absoluteFilePath(name);
+        if (QFileInfo(file).isFile())
+            return QStringList(file);
+        if (misses)
+            misses->insert(QDir::cleanPath(file));
+    }
+    return QStringList();
+}
+
 void CppParser::processInclude(const QString &file, ConversionData &cd, const QStringList &includeStack,
                                QSet<QString> &inclusions)
 {
     QString cleanFile = QDir::cleanPath(file);
 
-    for (const QString &ex : qAsConst(cd.m_excludes)) {
-        QRegularExpression rx(QRegularExpression::wildcardToRegularExpression(ex));
-        if (rx.match(cleanFile).hasMatch())
-            return;
-    }
+    if (isExcluded(cleanFile, cd))
+        return;
 
     const int index = includeStack.indexOf(cleanFile);
     if (index != -1) {
@@ -1266,19 +1560,30 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         && !CppFiles::isBlacklisted(cleanFile)
         && isHeader(cleanFile)) {
 
-        QSet<const ParseResults *> res = CppFiles::getResults(cleanFile);
+        bool claimed;
+        QSet<const ParseResults *> res = CppFiles::claimResults(cleanFile, &claimed);
         if (!res.isEmpty()) {
             results->includes.unite(res);
+            readFiles.insert(cleanFile);
+            readFiles.unite(CppFiles::getDependencies(cleanFile));
+            addMissingTrFunctions(CppFiles::getMissingTrFunctions(cleanFile));
             return;
         }
+        // Another thread parsing the file waits for this one. Treat the #include
+        // like one closing an include cycle.
+        if (!claimed)
+            return;
 
         isIndirect = true;
     }
 
+    readFiles.insert(cleanFile);
     QFile f(cleanFile);
     if (!f.open(QIODevice::ReadOnly)) {
         yyMsg() << qPrintable(
             QStringLiteral("Cannot open %1: %2\n").arg(cleanFile, f.errorString()));
+        if (isIndirect)
+            CppFiles::releaseClaim(cleanFile);
         return;
     }
 
@@ -1289,15 +1594,25 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
     inclusions.insert(cleanFile);
     if (isIndirect) {
         CppParser parser;
-        for (const QString &projectRoot : qAsConst(cd.m_projectRoots))
+        // Source files must yield the same messages no matter whether they are
+        // first come across as an #include or on their own.
+        bool collectMessages = CppFiles::isSourceFile(cleanFile);
+        for (const QString &projectRoot : qAsConst(cd.m_projectRoots)) {
             if (cleanFile.startsWith(projectRoot)) {
-                parser.setTranslator(new Translator);
+                collectMessages = true;
                 break;
             }
+        }
+        if (collectMessages)
+            parser.setTranslator(new Translator);
         parser.setInput(ts, cleanFile);
+        parser.setMessageStream(yyMsgStream);
         QStringList stack = includeStack;
         stack << cleanFile;
         parser.parse(cd, stack, inclusions);
+        readFiles.unite(parser.readFiles);
+        blacklisted.unite(parser.blacklisted);
+        addMissingTrFunctions(parser.missingTr);
         results->includes.insert(parser.recordResults(true));
     } else {
         CppParser parser(results);
@@ -1305,12 +1620,18 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         parser.functionContext = functionContext;
         parser.functionContextUnresolved = functionContextUnresolved;
         parser.setInput(ts, cleanFile);
+        parser.setMessageStream(yyMsgStream);
         parser.setTranslator(tor);
         QStringList stack = includeStack;
         stack << cleanFile;
         parser.parseInternal(cd, stack, inclusions);
-        // Avoid that messages obtained by direct scanning are used
-        CppFiles::setBlacklisted(cleanFile);
+        readFiles.unite(parser.readFiles);
+        blacklisted.unite(parser.blacklisted);
+        addMissingTrFunctions(parser.missingTr);
+        // Avoid that messages obtained by direct scanning are used. loadCPP()
+        // blacklists the file once all files are parsed, so the decisions
+        // taken above do not depend on the order of parsing.
+        blacklisted.insert(cleanFile);
     }
     inclusions.remove(cleanFile);
 
@@ -1479,11 +1800,7 @@ void CppParser::handleTr(QString &prefix, bool plural)
                     if (idx == 1) {
                         context = stringifyNamespace(functionContext);
                         fctx = findNamespace(functionContext)->classDef;
-                        if (!fctx->complained) {
-                            yyMsg() << qPrintable(
-                                QStringLiteral("Class '%1' lacks Q_OBJECT macro\n").arg(context));
-                            fctx->complained = true;
-                        }
+                        complainMissingTrFunctions(fctx, context);
                         goto gotctx;
                     }
                     --idx;
@@ -1496,7 +1813,6 @@ void CppParser::handleTr(QString &prefix, bool plural)
                             break;
                         context += QLatin1String("::");
                     }
-                    fctx->trQualification = context;
                 } else {
                     context = fctx->trQualification;
                 }
@@ -1516,18 +1832,13 @@ void CppParser::handleTr(QString &prefix, bool plural)
             NamespaceList nsl;
             NamespaceList unresolved;
             if (fullyQualify(functionContext, prefix, false, &nsl, &unresolved)) {
-                Namespace *fctx = findNamespace(nsl)->classDef;
-                if (fctx->trQualification.isEmpty()) {
+                const Namespace *fctx = findNamespace(nsl)->classDef;
+                if (fctx->trQualification.isEmpty())
                     context = stringifyNamespace(nsl);
-                    fctx->trQualification = context;
-                } else {
+                else
                     context = fctx->trQualification;
-                }
-                if (!fctx->hasTrFunctions && !fctx->complained) {
-                    yyMsg() << qPrintable(QStringLiteral("Class '%1' lacks Q_OBJECT macro\n")
-                                          .arg(context));
-                    fctx->complained = true;
-                }
+                if (!fctx->hasTrFunctions)
+                    complainMissingTrFunctions(fctx, context);
             } else {
                 context = joinNamespaces(stringifyNamespace(nsl), stringifyNamespace(0, unresolved));
             }
@@ -1637,6 +1948,25 @@ void CppParser::handleDeclareTrFunctions()
     ns->trQualification.detach();
 }
 
+void CppParser::addMissingTrFunctions(const QList<MissingTrFunctions> &missing)
+{
+    for (const MissingTrFunctions &m : missing) {
+        const auto sameClass = [&m](const MissingTrFunctions &other) {
+            return other.classDef == m.classDef;
+        };
+        if (std::none_of(missingTr.cbegin(), missingTr.cend(), sameClass))
+            missingTr.append(m);
+    }
+}
+
+void CppParser::complainMissingTrFunctions(const Namespace *classDef, const QString &context)
+{
+    std::ostringstream message;
+    message << qPrintable(yyFileName) << ':' << yyLineNo << ": "
+            << qPrintable(QStringLiteral("Class '%1' lacks Q_OBJECT macro\n").arg(context));
+    addMissingTrFunctions({ { classDef, message.str() } });
+}
+
 void CppParser::parse(ConversionData &cd, const QStringList &includeStack,
                       QSet<QString> &inclusions)
 {
@@ -1647,6 +1977,19 @@ void CppParser::parse(ConversionData &cd, const QStringList &includeStack,
     parseInternal(cd, includeStack, inclusions);
 }
 
+/*
+  Processes \a file as if it was #included at the top of an otherwise empty file.
+*/
+void CppParser::parseInclude(ConversionData &cd, const QString &file)
+{
+    namespaces << HashString();
+    functionContext = namespaces;
+    functionContextUnresolved.clear();
+
+    QSet<QString> inclusions;
+    processInclude(file, cd, QStringList(), inclusions);
+}
+
 void CppParser::parseInternal(ConversionData &cd, const QStringList &includeStack, QSet<QString> &inclusions)
 {
     static QString strColons(QLatin1String("::"));
@@ -1665,6 +2008,8 @@ void CppParser::parseInternal(ConversionData &cd, const QStringList &includeStac
     yyWord.reserve(yyInStr.size()); // Rather insane. That's because we do no length checking.
     yyWordInitialCapacity = yyWord.capacity();
     yyInPtr = (const ushort *)yyInStr.unicode();
+    const qsizetype inLen = yyInStr.indexOf(QChar::Null);
+    yyInEnd = yyInPtr + (inLen < 0 ? yyInStr.size() : inLen);
     yyCh = getChar();
     yyTok = getToken();
     while (yyTok != Tok_Eof) {
@@ -1678,32 +2023,12 @@ void CppParser::parseInternal(ConversionData &cd, const QStringList &includeStac
         }
         //qDebug() << "TOKEN: " << yyTok;
         switch (yyTok) {
-        case Tok_QuotedInclude: {
-            text = QDir(QFileInfo(yyFileName).absolutePath()).absoluteFilePath(yyWord);
-            text.detach();
-            if (QFileInfo(text).isFile()) {
-                processInclude(text, cd, includeStack, inclusions);
-                yyTok = getToken();
-                break;
-            }
-        }
-        Q_FALLTHROUGH();
+        case Tok_QuotedInclude:
         case Tok_AngledInclude: {
-            const QStringList cSources = cd.m_allCSources.values(yyWord);
-            if (!cSources.isEmpty()) {
-                for (const QString &cSource : cSources)
-                    processInclude(cSource, cd, includeStack, inclusions);
-                goto incOk;
-            }
-            for (const QString &incPath : qAsConst(cd.m_includePath)) {
-                text = QDir(incPath).absoluteFilePath(yyWord);
-                text.detach();
-                if (QFileInfo(text).isFile()) {
-                    processInclude(text, cd, includeStack, inclusions);
-                    goto incOk;
-                }
-            }
-          incOk:
+            const QStringList files = resolveInclude(yyFileName, yyWord,
+                                                     yyTok == Tok_QuotedInclude, cd, &readFiles);
+            for (const QString &file : files)
+                processInclude(file, cd, includeStack, inclusions);
             yyTok = getToken();
             break;
         }
@@ -2206,6 +2531,8 @@ const ParseResults *CppParser::recordResults(bool isHeader)
             results->fileId = nextFileId++;
             pr = results;
         }
+        CppFiles::setDependencies(yyFileName, readFiles);
+        CppFiles::setMissingTrFunctions(yyFileName, missingTr);
         CppFiles::setResults(yyFileName, pr);
         return pr;
     } else {
@@ -2214,41 +2541,357 @@ const ParseResults *CppParser::recordResults(bool isHeader)
     }
 }
 
+/*
+  Everything besides the file contents that influences what the parser extracts.
+*/
+static QByteArray cppOptionsHash(const ConversionData &cd)
+{
+    QStringList allCSources;
+    for (auto it = cd.m_allCSources.cbegin(), end = cd.m_allCSources.cend(); it != end; ++it)
+        allCSources << it.key() + QLatin1Char('=') + it.value();
+    allCSources.sort();
+    QStringList projectRoots(cd.m_projectRoots.cbegin(), cd.m_projectRoots.cend());
+    projectRoots.sort();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const auto addList = [&hash](const QStringList &list) {
+        hash.addData(list.join(QLatin1Char('\n')).toUtf8());
+        hash.addData(QByteArrayView("\0", 1));
+    };
+    addList(QStringList(QLatin1String(QT_VERSION_STR)));
+    addList(QStringList(QString::number(cd.m_sourceIsUtf16)));
+    addList(cd.m_includePath);
+    addList(allCSources);
+    addList(cd.m_excludes);
+    addList(projectRoots);
+    addList(trFunctionAliasManager.listAliases());
+    return hash.result();
+}
+
+/*
+  Lists the files \a fileName may #include. Everything that looks like an
+  #include directive counts, including ones in comments and in disabled #if
+  branches, so the parser never follows an #include missing here.
+*/
+static QStringList scanIncludes(const QString &fileName, const ConversionData &cd,
+                                QStringConverter::Encoding e)
+{
+    QStringList includes;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return includes;
+    QTextStream ts(&file);
+    ts.setEncoding(e);
+    ts.setAutoDetectUnicode(true);
+    QString text = ts.readAll();
+    // Fold line continuations like CppParser::getChar() does
+    text.remove(QLatin1String("\\\r\n"));
+    text.remove(QLatin1String("\\\n"));
+    text.remove(QLatin1String("\\\r"));
+
+    const auto isSpace = [](QChar c) {
+        return c == u' ' || c == u'\t' || c == u'\n' || c == u'\v' || c == u'\f' || c == u'\r';
+    };
+    const QChar *end = text.constData() + text.size();
+    bool atNewline = true;
+    for (const QChar *p = text.constData(); p != end; ++p) {
+        if (*p == u'\n' || *p == u'\r') {
+            atNewline = true;
+            continue;
+        }
+        if (*p == u' ' || *p == u'\t')
+            continue;
+        if (*p != u'#' || !atNewline) {
+            atNewline = false;
+            continue;
+        }
+        const QChar *q = p + 1;
+        while (q != end && (*q == u'#' || (isSpace(*q) && *q != u'\n' && *q != u'\r')))
+            ++q;
+        if (end - q < 2 || q[0] != u'i' || q[1] != u'n')
+            continue;
+        q += 2;
+        while (q != end && !isSpace(*q) && *q != u'"' && *q != u'<')
+            ++q;
+        while (q != end && isSpace(*q))
+            ++q;
+        if (q == end || (*q != u'"' && *q != u'<'))
+            continue;
+        const QChar close = *q == u'"' ? u'"' : u'>';
+        const QChar *name = ++q;
+        while (q != end && *q != close && *q != u'\n' && *q != u'\r')
+            ++q;
+        includes += resolveInclude(fileName, QString(name, q - name), close == u'"', cd);
+    }
+    return includes;
+}
+
+namespace {
+/*
+  The include cycles among the files to parse, as far as they can be told
+  without parsing. These are the strongly connected components of the
+  #include graph, found with Tarjan's algorithm.
+*/
+class IncludeGraph
+{
+public:
+    IncludeGraph(const ConversionData &cd, QStringConverter::Encoding e)
+        : m_cd(cd), m_encoding(e)
+    {
+    }
+
+    void addFile(const QString &fileName)
+    {
+        if (!m_nodes.contains(fileName))
+            visit(fileName);
+    }
+
+    // Each cycle lists its files in the order they were come across. Cycles
+    // come after the cycles they #include.
+    const QList<QStringList> &cycles() const { return m_cycles; }
+
+private:
+    struct Node
+    {
+        int index;
+        int lowLink;
+        bool onStack;
+    };
+
+    void visit(const QString &fileName);
+
+    const ConversionData &m_cd;
+    QStringConverter::Encoding m_encoding;
+    QHash<QString, Node> m_nodes;
+    QStringList m_stack;
+    QList<QStringList> m_cycles;
+};
+
+void IncludeGraph::visit(const QString &fileName)
+{
+    const int index = int(m_nodes.size());
+    m_nodes.insert(fileName, { index, index, true });
+    m_stack.append(fileName);
+
+    bool includesItself = false;
+    const QStringList includes = scanIncludes(fileName, m_cd, m_encoding);
+    for (const QString &include : includes) {
+        const QString cleanFile = QDir::cleanPath(include);
+        if (isExcluded(cleanFile, m_cd))
+            continue;
+        if (cleanFile == fileName)
+            includesItself = true;
+        const auto it = m_nodes.constFind(cleanFile);
+        int lowLink;
+        if (it == m_nodes.cend()) {
+            visit(cleanFile);
+            lowLink = m_nodes.value(cleanFile).lowLink;
+        } else if (it->onStack) {
+            lowLink = it->index;
+        } else {
+            continue;
+        }
+        Node &node = m_nodes[fileName];
+        node.lowLink = qMin(node.lowLink, lowLink);
+    }
+
+    if (m_nodes.value(fileName).lowLink != index)
+        return;
+    const qsizetype start = m_stack.lastIndexOf(fileName);
+    const QStringList component = m_stack.mid(start);
+    m_stack.resize(start);
+    for (const QString &member : component)
+        m_nodes[member].onStack = false;
+    if (component.size() > 1 || includesItself)
+        m_cycles.append(component);
+}
+
+struct CppParseJob
+{
+    QString fileName;
+    bool parsed = false;
+    QString error;
+    std::string diagnostics;
+    QSet<QString> dependencies;
+    QSet<QString> directIncludes;
+    QList<MissingTrFunctions> missingTrFunctions;
+};
+}
+
+static void parseCppFile(CppParseJob *job, ConversionData &cd, QStringConverter::Encoding e)
+{
+    const QString &filename = job->fileName;
+    const bool header = isHeader(filename);
+
+    // Another thread may have come across the file as an #include already.
+    bool claimed = false;
+    if (header && !CppFiles::claimResults(filename, &claimed).isEmpty()) {
+        job->missingTrFunctions = CppFiles::getMissingTrFunctions(filename);
+        return;
+    }
+    if (CppFiles::isBlacklisted(filename)) {
+        if (claimed)
+            CppFiles::releaseClaim(filename);
+        return;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        job->error = QStringLiteral("Cannot open %1: %2").arg(filename, file.errorString());
+        if (claimed)
+            CppFiles::releaseClaim(filename);
+        return;
+    }
+
+    std::ostringstream diagnostics;
+    CppParser parser;
+    QTextStream ts(&file);
+    ts.setEncoding(e);
+    ts.setAutoDetectUnicode(true);
+    parser.setInput(ts, filename);
+    parser.setMessageStream(&diagnostics);
+    Translator *tor = new Translator;
+    parser.setTranslator(tor);
+    QSet<QString> inclusions;
+    parser.parse(cd, QStringList(), inclusions);
+    parser.recordResults(header);
+
+    job->parsed = true;
+    job->diagnostics = diagnostics.str();
+    job->dependencies = parser.dependencies();
+    job->directIncludes = parser.directIncludes();
+    job->missingTrFunctions = parser.missingTrFunctions();
+}
+
 void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd)
 {
     QStringConverter::Encoding e = cd.m_sourceIsUtf16 ? QStringConverter::Utf16 : QStringConverter::Utf8;
 
+    std::unique_ptr<ExtractionCache> cache;
+    QByteArray optionsHash;
+    QHash<QString, QList<TranslatorMessage>> cachedMessages;
+    if (!cd.m_extractionCacheFile.isEmpty()) {
+        cache.reset(new ExtractionCache(cd.m_extractionCacheFile));
+        cache->load();
+        optionsHash = cppOptionsHash(cd);
+    }
+
+    CppFiles::setSourceFiles(filenames);
+
+    // Files are blacklisted only after all of them are parsed or taken from
+    // the cache, see below.
+    QSet<QString> blacklisted;
+    std::vector<CppParseJob> jobs;
+    jobs.reserve(filenames.size());
     for (const QString &filename : filenames) {
         if (!CppFiles::getResults(filename).isEmpty() || CppFiles::isBlacklisted(filename))
             continue;
 
-        QFile file(filename);
-        if (!file.open(QIODevice::ReadOnly)) {
-            cd.appendError(QStringLiteral("Cannot open %1: %2").arg(filename,
-                                                                    file.errorString()));
-            continue;
+        if (cache) {
+            if (const ExtractionCache::Entry *entry = cache->lookup(filename, optionsHash)) {
+                for (const QString &include : entry->blacklisted)
+                    blacklisted.insert(include);
+                cachedMessages.insert(filename, entry->messages);
+                continue;
+            }
         }
 
-        CppParser parser;
-        QTextStream ts(&file);
-        ts.setEncoding(e);
-        ts.setAutoDetectUnicode(true);
-        parser.setInput(ts, filename);
-        Translator *tor = new Translator;
-        parser.setTranslator(tor);
-        QSet<QString> inclusions;
-        parser.parse(cd, QStringList(), inclusions);
-        parser.recordResults(isHeader(filename));
+        CppParseJob job;
+        job.fileName = filename;
+        jobs.push_back(std::move(job));
+    }
+
+    // The alias map is built lazily; make sure this does not happen concurrently.
+    trFunctionAliasManager.nameToTrFunctionMap();
+
+    // What the headers of an include cycle yield depends on which of them is
+    // parsed first, so parse them up front, one at a time. The other headers
+    // yield the same no matter which thread comes across them first. For the
+    // same reason, files are blacklisted only after all of them are parsed.
+    {
+        IncludeGraph graph(cd, e);
+        for (const CppParseJob &job : jobs)
+            graph.addFile(job.fileName);
+        for (const QStringList &cycle : graph.cycles()) {
+            for (const QString &filename : cycle) {
+                if (isHeader(filename) && !CppFiles::isBlacklisted(filename)) {
+                    CppParser parser;
+                    parser.parseInclude(cd, filename);
+                    parser.deleteResults();
+                    blacklisted.unite(parser.directIncludes());
+                }
+            }
+            CppFiles::addIncludeCycle(QSet<QString>(cycle.cbegin(), cycle.cend()));
+        }
+    }
+
+    std::atomic<size_t> nextJob = 0;
+    const auto parseJobs = [&jobs, &nextJob, &cd, e]() {
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+            parseCppFile(&jobs[i], cd, e);
+    };
+    const size_t threadCount = cd.m_threadCount > 0
+            ? size_t(cd.m_threadCount) : size_t(std::thread::hardware_concurrency());
+    const size_t idealThreadCount = std::min(jobs.size(), threadCount);
+    if (idealThreadCount > 1) {
+        std::vector<std::thread> workers;
+        workers.reserve(idealThreadCount);
+        for (size_t i = 0; i < idealThreadCount; ++i)
+            workers.emplace_back(parseJobs);
+        for (std::thread &worker : workers)
+            worker.join();
+    } else {
+        parseJobs();
     }
 
+    // Report in input order, so the output does not depend on the scheduling.
+    // Which file a class lacking tr() functions is reported for depends on
+    // that order alone, too.
+    QSet<const Namespace *> complainedClasses;
+    for (const CppParseJob &job : jobs) {
+        std::cerr << job.diagnostics;
+        for (const MissingTrFunctions &missing : job.missingTrFunctions) {
+            if (!complainedClasses.contains(missing.classDef)) {
+                complainedClasses.insert(missing.classDef);
+                std::cerr << missing.message;
+            }
+        }
+        if (!job.error.isEmpty())
+            cd.appendError(job.error);
+        blacklisted.unite(job.directIncludes);
+        if (!cache || !job.parsed)
+            continue;
+
+        ExtractionCache::Entry entry;
+        entry.optionsHash = optionsHash;
+        entry.contentHash = cache->fileHash(job.fileName);
+        for (const QString &dependency : job.dependencies)
+            entry.dependencies.insert(dependency, cache->fileHash(dependency));
+        entry.blacklisted = QStringList(job.directIncludes.cbegin(), job.directIncludes.cend());
+        if (const Translator *tor = CppFiles::getTranslator(job.fileName))
+            entry.messages = tor->messages();
+        cache->insert(job.fileName, entry);
+    }
+    for (const QString &filename : qAsConst(blacklisted))
+        CppFiles::setBlacklisted(filename);
+
     for (const QString &filename : filenames) {
         if (!CppFiles::isBlacklisted(filename)) {
-            if (const Translator *tor = CppFiles::getTranslator(filename)) {
+            const auto cached = cachedMessages.constFind(filename);
+            if (cached != cachedMessages.cend()) {
+                for (const TranslatorMessage &msg : cached.value())
+                    translator.extend(msg, cd);
+            } else if (const Translator *tor = CppFiles::getTranslator(filename)) {
                 for (const TranslatorMessage &msg : tor->messages())
                     translator.extend(msg, cd);
             }
         }
     }
+
+    if (cache && !cache->save()) {
+        cd.appendError(QStringLiteral("Cannot write extraction cache %1")
+                       .arg(cd.m_extractionCacheFile));
+    }
 }
 
 QT_END_NAMESPACE
@@ -6,30 +6,35 @@
 
 #include "lupdate.h"
 
+#include <QtCore/QMutex>
 #include <QtCore/QSet>
+#include <QtCore/QWaitCondition>
 
 #include <iostream>
+#include <string>
 
 QT_BEGIN_NAMESPACE
 
+// The hashes are computed up front, as the parse results holding these are
+// read by several parser threads at once.
 struct HashString {
-    HashString() : m_hash(0x80000000) {}
-    explicit HashString(const QString &str) : m_str(str), m_hash(0x80000000) {}
-    void setValue(const QString &str) { m_str = str; m_hash = 0x80000000; }
+    HashString() : m_hash(qHash(QString()) & 0x7fffffff) {}
+    explicit HashString(const QString &str) : m_str(str), m_hash(qHash(str) & 0x7fffffff) {}
+    void setValue(const QString &str) { m_str = str; m_hash = qHash(str) & 0x7fffffff; }
     const QString &value() const { return m_str; }
     bool operator==(const HashString &other) const { return m_str == other.m_str; }
     QString m_str;
 
-    mutable uint m_hash; // We use the highest bit as a validity indicator (set => invalid)
+    uint m_hash;
 };
 
 struct HashStringList {
-    explicit HashStringList(const QList<HashString> &list) : m_list(list), m_hash(0x80000000) {}
+    explicit HashStringList(const QList<HashString> &list);
     const QList<HashString> &value() const { return m_list; }
     bool operator==(const HashStringList &other) const { return m_list == other.m_list; }
 
     QList<HashString> m_list;
-    mutable uint m_hash; // We use the highest bit as a validity indicator (set => invalid)
+    uint m_hash;
 };
 
 typedef QList<HashString> NamespaceList;
@@ -38,7 +43,7 @@ struct Namespace {
 
     Namespace() :
             classDef(this),
-            hasTrFunctions(false), complained(false)
+            hasTrFunctions(false)
     {}
     ~Namespace()
     {
@@ -65,7 +70,12 @@ struct Namespace {
     QString trQualification;
 
     bool hasTrFunctions;
-    bool complained; // ... that tr functions are missing.
+};
+
+// A class used with tr() which has no tr() functions, and the warning about it
+struct MissingTrFunctions {
+    const Namespace *classDef;
+    std::string message;
 };
 
 struct ParseResults {
@@ -82,21 +92,38 @@ struct IncludeCycle {
 typedef QHash<QString, IncludeCycle *> IncludeCycleHash;
 typedef QHash<QString, const Translator *> TranslatorHash;
 
+// The registry is shared by all parser threads, so all accesses are serialized.
 class CppFiles {
 
 public:
     static QSet<const ParseResults *> getResults(const QString &cleanFile);
+    static QSet<const ParseResults *> claimResults(const QString &cleanFile, bool *claimed);
+    static void releaseClaim(const QString &cleanFile);
     static void setResults(const QString &cleanFile, const ParseResults *results);
     static const Translator *getTranslator(const QString &cleanFile);
     static void setTranslator(const QString &cleanFile, const Translator *results);
     static bool isBlacklisted(const QString &cleanFile);
     static void setBlacklisted(const QString &cleanFile);
+    static bool isSourceFile(const QString &cleanFile);
+    static void setSourceFiles(const QStringList &cleanFiles);
     static void addIncludeCycle(const QSet<QString> &fileNames);
+    static QSet<QString> getDependencies(const QString &cleanFile);
+    static void setDependencies(const QString &cleanFile, const QSet<QString> &dependencies);
+    static QList<MissingTrFunctions> getMissingTrFunctions(const QString &cleanFile);
+    static void setMissingTrFunctions(const QString &cleanFile,
+                                      const QList<MissingTrFunctions> &missing);
 
 private:
+    static QMutex &mutex();
+    static QWaitCondition &resultsAvailable();
     static IncludeCycleHash &includeCycles();
     static TranslatorHash &translatedFiles();
     static QSet<QString> &blacklistedFiles();
+    static QSet<QString> &sourceFiles();
+    static QHash<QString, QSet<QString>> &fileDependencies();
+    static QHash<QString, QList<MissingTrFunctions>> &fileMissingTrFunctions();
+    static QHash<QString, Qt::HANDLE> &claimedFiles();
+    static QHash<Qt::HANDLE, QString> &waitingThreads();
 };
 
 QT_END_NAMESPACE
@@ -4,7 +4,6 @@
 #include "cpp_clang.h"
 #include "clangtoolastreader.h"
 #include "filesignificancecheck.h"
-#include "lupdatepreprocessoraction.h"
 #include "synchronized.h"
 #include "translator.h"
 
@@ -457,29 +456,13 @@ void ClangCppParser::loadCPP(Translator &translator, const QStringList &files, C
     TranslationStores ast, qdecl, qnoop;
     Stores stores(ast, qdecl, qnoop);
 
+    // Each file is compiled once: the preprocessor callbacks and the AST
+    // visitor run within the same LupdateFrontendAction.
     std::vector<std::thread> producers;
-    ReadSynchronizedRef<std::string> ppSources(sources);
-    WriteSynchronizedRef<TranslationRelatedStore> ppStore(stores.Preprocessor);
-    size_t idealProducerCount = std::min(ppSources.size(), size_t(std::thread::hardware_concurrency()));
+    ReadSynchronizedRef<std::string> astSources(sources);
+    size_t idealProducerCount = std::min(astSources.size(), size_t(std::thread::hardware_concurrency()));
     clang::tooling::ArgumentsAdjuster argumentsAdjuster = getClangArgumentAdjuster();
 
-    for (size_t i = 0; i < idealProducerCount; ++i) {
-        std::thread producer([&ppSources, &db, &ppStore, &argumentsAdjuster]() {
-            std::string file;
-            while (ppSources.next(&file)) {
-                clang::tooling::ClangTool tool(*db, file);
-                tool.appendArgumentsAdjuster(argumentsAdjuster);
-                tool.run(new LupdatePreprocessorActionFactory(&ppStore));
-            }
-        });
-        producers.emplace_back(std::move(producer));
-    }
-    for (auto &producer : producers)
-        producer.join();
-    producers.clear();
-
-    ReadSynchronizedRef<std::string> astSources(sources);
-    idealProducerCount = std::min(astSources.size(), size_t(std::thread::hardware_concurrency()));
     for (size_t i = 0; i < idealProducerCount; ++i) {
         std::thread producer([&astSources, &db, &stores, &argumentsAdjuster]() {
             std::string file;
@@ -217,7 +217,6 @@ struct Stores
         , QNoopTranlsationWithContext(qn)
     {}
 
-    TranslationStores Preprocessor;
     WriteSynchronizedRef<TranslationRelatedStore> AST;
     WriteSynchronizedRef<TranslationRelatedStore> QDeclareTrWithContext;
     WriteSynchronizedRef<TranslationRelatedStore> QNoopTranlsationWithContext; // or with warnings that need to be
@@ -0,0 +1,188 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "extractioncache.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+
+QT_BEGIN_NAMESPACE
+
+static const quint32 cacheMagic = 0x4c55434b; // "LUCK"
+static const quint32 cacheVersion = 2;
+
+static void writeMessage(QDataStream &s, const TranslatorMessage &msg)
+{
+    s << msg.id() << msg.context() << msg.sourceText() << msg.oldSourceText()
+      << msg.comment() << msg.oldComment() << msg.userData() << msg.extraComment()
+      << msg.translatorComment() << msg.warning() << msg.translations() << msg.extras()
+      << msg.fileName() << qint32(msg.lineNumber()) << qint32(msg.type())
+      << msg.isPlural() << msg.warningOnly();
+    const TranslatorMessage::References refs = msg.extraReferences();
+    s << quint32(refs.size());
+    for (const TranslatorMessage::Reference &ref : refs)
+        s << ref.fileName() << qint32(ref.lineNumber());
+}
+
+static TranslatorMessage readMessage(QDataStream &s)
+{
+    QString id, context, sourceText, oldSourceText, comment, oldComment, userData;
+    QString extraComment, translatorComment, warning, fileName;
+    QStringList translations;
+    TranslatorMessage::ExtraData extras;
+    qint32 lineNumber, type;
+    bool plural, warningOnly;
+    quint32 refCount;
+    s >> id >> context >> sourceText >> oldSourceText >> comment >> oldComment >> userData
+      >> extraComment >> translatorComment >> warning >> translations >> extras
+      >> fileName >> lineNumber >> type >> plural >> warningOnly >> refCount;
+
+    TranslatorMessage msg(context, sourceText, comment, userData, fileName, lineNumber,
+                          translations, TranslatorMessage::Type(type), plural);
+    msg.setId(id);
+    msg.setOldSourceText(oldSourceText);
+    msg.setOldComment(oldComment);
+    msg.setExtraComment(extraComment);
+    msg.setTranslatorComment(translatorComment);
+    msg.setWarning(warning);
+    msg.setExtras(extras);
+    msg.setWarningOnly(warningOnly);
+    for (quint32 i = 0; i < refCount && s.status() == QDataStream::Ok; ++i) {
+        QString refFileName;
+        qint32 refLineNumber;
+        s >> refFileName >> refLineNumber;
+        msg.addReference(refFileName, refLineNumber);
+    }
+    return msg;
+}
+
+ExtractionCache::ExtractionCache(const QString &fileName)
+    : m_fileName(fileName)
+{
+}
+
+/*
+  Reads the cache file. A missing, outdated or corrupt file simply yields an
+  empty cache, as all of its contents can be recomputed.
+*/
+bool ExtractionCache::load()
+{
+    m_entries.clear();
+
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream s(&file);
+    s.setVersion(QDataStream::Qt_6_0);
+    quint32 magic, version, count;
+    s >> magic >> version;
+    if (magic != cacheMagic || version != cacheVersion)
+        return false;
+
+    s >> count;
+    for (quint32 i = 0; i < count && s.status() == QDataStream::Ok; ++i) {
+        QString fileName;
+        Entry entry;
+        quint32 messageCount;
+        s >> fileName >> entry.optionsHash >> entry.contentHash >> entry.dependencies
+          >> entry.blacklisted >> messageCount;
+        for (quint32 j = 0; j < messageCount && s.status() == QDataStream::Ok; ++j)
+            entry.messages.append(readMessage(s));
+        m_entries.insert(fileName, entry);
+    }
+
+    if (s.status() != QDataStream::Ok) {
+        m_entries.clear();
+        return false;
+    }
+    return true;
+}
+
+/*
+  Writes the cache file if anything changed. Entries of files which do not
+  exist anymore are dropped.
+*/
+bool ExtractionCache::save()
+{
+    if (!m_modified)
+        return true;
+
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream s(&file);
+    s.setVersion(QDataStream::Qt_6_0);
+    s << cacheMagic << cacheVersion;
+
+    QList<QString> fileNames;
+    fileNames.reserve(m_entries.size());
+    for (auto it = m_entries.cbegin(), end = m_entries.cend(); it != end; ++it) {
+        if (QFile::exists(it.key()))
+            fileNames.append(it.key());
+    }
+
+    s << quint32(fileNames.size());
+    for (const QString &fileName : qAsConst(fileNames)) {
+        const Entry &entry = m_entries[fileName];
+        s << fileName << entry.optionsHash << entry.contentHash << entry.dependencies
+          << entry.blacklisted << quint32(entry.messages.size());
+        for (const TranslatorMessage &msg : entry.messages)
+            writeMessage(s, msg);
+    }
+
+    if (s.status() != QDataStream::Ok || !file.commit())
+        return false;
+    m_modified = false;
+    return true;
+}
+
+/*
+  Returns the entry for \a fileName, or \nullptr if there is none or if the
+  file, any of its dependencies, or the parser options changed since.
+*/
+const ExtractionCache::Entry *ExtractionCache::lookup(const QString &fileName,
+                                                      const QByteArray &optionsHash)
+{
+    const auto it = m_entries.constFind(fileName);
+    if (it == m_entries.cend() || it->optionsHash != optionsHash
+        || it->contentHash != fileHash(fileName)) {
+        return nullptr;
+    }
+    for (auto dep = it->dependencies.cbegin(), end = it->dependencies.cend(); dep != end; ++dep) {
+        if (dep.value() != fileHash(dep.key()))
+            return nullptr;
+    }
+    return &it.value();
+}
+
+void ExtractionCache::insert(const QString &fileName, const Entry &entry)
+{
+    m_entries.insert(fileName, entry);
+    m_modified = true;
+}
+
+/*
+  Returns the hash of the contents of \a fileName, or an empty byte array if
+  the file cannot be read.
+*/
+QByteArray ExtractionCache::fileHash(const QString &fileName)
+{
+    auto it = m_fileHashes.find(fileName);
+    if (it == m_fileHashes.end()) {
+        QByteArray hash;
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            QCryptographicHash hasher(QCryptographicHash::Sha1);
+            if (hasher.addData(&file))
+                hash = hasher.result();
+        }
+        it = m_fileHashes.insert(fileName, hash);
+    }
+    return it.value();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,58 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef EXTRACTIONCACHE_H
+#define EXTRACTIONCACHE_H
+
+#include <translatormessage.h>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+QT_BEGIN_NAMESPACE
+
+/*
+  Persistent store of the messages extracted from individual source files.
+
+  An entry is valid as long as the source file, every file that was read while
+  parsing it, and the parser options are unchanged. Files are compared by the
+  hash of their contents, so touching a file without modifying it does not
+  invalidate anything. The places where an #include was looked for in vain
+  are recorded as dependencies with an empty hash, so that a header created
+  there later, shadowing the one found before, invalidates the entry.
+*/
+class ExtractionCache
+{
+public:
+    struct Entry
+    {
+        QByteArray optionsHash;
+        QByteArray contentHash;
+        QHash<QString, QByteArray> dependencies; // file name -> content hash
+        QStringList blacklisted; // files that were included directly
+        QList<TranslatorMessage> messages;
+    };
+
+    explicit ExtractionCache(const QString &fileName);
+
+    bool load();
+    bool save();
+
+    const Entry *lookup(const QString &fileName, const QByteArray &optionsHash);
+    void insert(const QString &fileName, const Entry &entry);
+
+    QByteArray fileHash(const QString &fileName);
+
+private:
+    QString m_fileName;
+    QHash<QString, Entry> m_entries;
+    QHash<QString, QByteArray> m_fileHashes; // memoized for the lifetime of the cache
+    bool m_modified = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // EXTRACTIONCACHE_H
@@ -46,30 +46,31 @@ class Scope
 
 /*
   The tokenizer maintains the following global variables. The names
-  should be self-explanatory.
+  should be self-explanatory. Files are parsed on several threads at
+  once, so each thread has its own.
 */
 
-static QString yyFileName;
-static QChar yyCh;
-static QString yyIdent;
-static QString yyComment;
-static QString yyString;
-static bool yyEOF = false;
+static thread_local QString yyFileName;
+static thread_local QChar yyCh;
+static thread_local QString yyIdent;
+static thread_local QString yyComment;
+static thread_local QString yyString;
+static thread_local bool yyEOF = false;
 
-static qlonglong yyInteger;
-static int yyParenDepth;
-static int yyLineNo;
-static int yyCurLineNo;
-static int yyParenLineNo;
-static int yyTok;
+static thread_local qlonglong yyInteger;
+static thread_local int yyParenDepth;
+static thread_local int yyLineNo;
+static thread_local int yyCurLineNo;
+static thread_local int yyParenLineNo;
+static thread_local int yyTok;
 
 // the string to read from and current position in the string
-static QString yyInStr;
-static int yyInPos;
+static thread_local QString yyInStr;
+static thread_local int yyInPos;
 
 // The parser maintains the following global variables.
-static QString yyPackage;
-static QStack<Scope*> yyScope;
+static thread_local QString yyPackage;
+static thread_local QStack<Scope*> yyScope;
 
 std::ostream &yyMsg(int line = 0)
 {
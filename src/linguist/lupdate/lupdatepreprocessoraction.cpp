@@ -86,7 +86,7 @@ void LupdatePPCallbacks::MacroExpands(const clang::Token &token,
         storeMacroArguments(arguments, &store);
     }
     if (store.isValid())
-        m_ppStores.emplace_back(std::move(store));
+        m_stores->emplace_back(std::move(store));
 }
 
 void LupdatePPCallbacks::storeMacroArguments(const std::vector<QString> &args,
@@ -154,14 +154,21 @@ void LupdatePPCallbacks::SourceRangeSkipped(clang::SourceRange sourceRange,
 }
 
 // To list the included files
-void LupdatePPCallbacks::InclusionDirective(clang::SourceLocation /*hashLoc*/,
-    const clang::Token & /*includeTok*/, clang::StringRef /*fileName*/, bool /*isAngled*/,
+void LupdatePPCallbacks::InclusionDirective(clang::SourceLocation hashLoc,
+    const clang::Token & /*includeTok*/, clang::StringRef fileName, bool /*isAngled*/,
     clang::CharSourceRange /*filenameRange*/, const clang::FileEntry *file,
     clang::StringRef /*searchPath*/, clang::StringRef /*relativePath*/,
     const clang::Module */*imported*/, clang::SrcMgr::CharacteristicKind /*fileType*/)
 {
-    if (!file)
+    if (!file) {
+        // Missing includes are not errors to clang here, so that it goes on
+        // expanding the rest of the file. Report them instead.
+        const auto &sm = m_preprocessor.getSourceManager();
+        qWarning("%s:%u:%u: '%s' file not found",
+                 sm.getFilename(hashLoc).str().c_str(), sm.getExpansionLineNumber(hashLoc),
+                 sm.getExpansionColumnNumber(hashLoc), fileName.str().c_str());
         return;
+    }
 
     clang::StringRef fileNameRealPath = file->tryGetRealPathName();
     if (!LupdatePrivate::isFileSignificant(fileNameRealPath.str()))
@@ -178,7 +185,7 @@ void LupdatePPCallbacks::InclusionDirective(clang::SourceLocation /*hashLoc*/,
     // when traversing the AST
 
     if (store.isValid())
-        m_ppStores.emplace_back(std::move(store));
+        m_stores->emplace_back(std::move(store));
 }
 
 QT_END_NAMESPACE
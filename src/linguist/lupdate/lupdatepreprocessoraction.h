@@ -5,7 +5,6 @@
 #define LUPDATEPREPROCESSORACTION_H
 
 #include "cpp_clang.h"
-#include "synchronized.h"
 
 #if defined(Q_CC_MSVC)
 # pragma warning(push)
@@ -15,9 +14,6 @@
 # pragma warning(disable: 4624)
 #endif
 
-#include <clang/Frontend/CompilerInstance.h>
-#include <clang/Frontend/FrontendActions.h>
-#include <clang/Tooling/Tooling.h>
 #include <clang/Lex/PPCallbacks.h>
 #include <clang/Lex/Preprocessor.h>
 
@@ -25,14 +21,18 @@
 # pragma warning(pop)
 #endif
 
-#include <memory>
-
 QT_BEGIN_NAMESPACE
 
+/*
+    Collects the translation related macro expansions and inclusion
+    directives of one translation unit. The callbacks are installed by
+    LupdateFrontendAction, so that they run during the same compile as the
+    AST visitor that consumes their results.
+*/
 class LupdatePPCallbacks : public clang::PPCallbacks
 {
 public:
-    LupdatePPCallbacks(WriteSynchronizedRef<TranslationRelatedStore> *stores, clang::Preprocessor &pp)
+    LupdatePPCallbacks(TranslationStores *stores, clang::Preprocessor &pp)
         : m_preprocessor(pp)
         , m_stores(stores)
     {
@@ -40,11 +40,6 @@ public:
         m_inputFile = sm.getFileEntryForID(sm.getMainFileID())->getName();
     }
 
-    ~LupdatePPCallbacks() override
-    {
-        m_stores->emplace_bulk(std::move(m_ppStores));
-    }
-
 private:
     void MacroExpands(const clang::Token &token, const clang::MacroDefinition &macroDefinition,
         clang::SourceRange sourceRange, const clang::MacroArgs *macroArgs) override;
@@ -52,8 +47,8 @@ private:
     void storeMacroArguments(const std::vector<QString> &args, TranslationRelatedStore *store);
 
     void SourceRangeSkipped(clang::SourceRange sourceRange, clang::SourceLocation endifLoc) override;
-    void InclusionDirective(clang::SourceLocation /*hashLoc*/, const clang::Token &/*includeTok*/,
-                            clang::StringRef /*fileName*/, bool /*isAngled*/,
+    void InclusionDirective(clang::SourceLocation hashLoc, const clang::Token &/*includeTok*/,
+                            clang::StringRef fileName, bool /*isAngled*/,
                             clang::CharSourceRange /*filenameRange*/, const clang::FileEntry *file,
                             clang::StringRef /*searchPath*/, clang::StringRef /*relativePath*/,
                             const clang::Module */*imported*/,
@@ -62,53 +57,7 @@ private:
     std::string m_inputFile;
     clang::Preprocessor &m_preprocessor;
 
-    TranslationStores m_ppStores;
-    WriteSynchronizedRef<TranslationRelatedStore> *m_stores { nullptr };
-};
-
-class LupdatePreprocessorAction : public clang::PreprocessOnlyAction
-{
-public:
-    LupdatePreprocessorAction(WriteSynchronizedRef<TranslationRelatedStore> *stores)
-        : m_stores(stores)
-    {}
-
-private:
-    void ExecuteAction() override
-    {
-        auto &preprocessor = getCompilerInstance().getPreprocessor();
-        preprocessor.SetSuppressIncludeNotFoundError(true);
-        auto callbacks = new LupdatePPCallbacks(m_stores, preprocessor);
-        preprocessor.addPPCallbacks(std::unique_ptr<clang::PPCallbacks>(callbacks));
-
-        clang::PreprocessOnlyAction::ExecuteAction();
-    }
-
-private:
-    WriteSynchronizedRef<TranslationRelatedStore> *m_stores { nullptr };
-};
-
-class LupdatePreprocessorActionFactory : public clang::tooling::FrontendActionFactory
-{
-public:
-    explicit LupdatePreprocessorActionFactory(WriteSynchronizedRef<TranslationRelatedStore> *stores)
-        : m_stores(stores)
-    {}
-
-#if (LUPDATE_CLANG_VERSION >= LUPDATE_CLANG_VERSION_CHECK(10,0,0))
-    std::unique_ptr<clang::FrontendAction> create() override
-    {
-        return std::make_unique<LupdatePreprocessorAction>(m_stores);
-    }
-#else
-    clang::FrontendAction *create() override
-    {
-        return new LupdatePreprocessorAction(m_stores);
-    }
-#endif
-
-private:
-    WriteSynchronizedRef<TranslationRelatedStore> *m_stores { nullptr };
+    TranslationStores *m_stores { nullptr };
 };
 
 QT_END_NAMESPACE
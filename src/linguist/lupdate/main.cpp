@@ -20,9 +20,18 @@
 #include <QtCore/QLibraryInfo>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QThread>
 #include <QtCore/QTranslator>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using namespace Qt::StringLiterals;
 
@@ -30,6 +39,8 @@ bool useClangToParseCpp = false;
 QString commandLineCompilationDatabaseDir; // for the path to the json file passed as a command line argument.
                                     // Has priority over what is in the .pro file and passed to the project.
 QStringList rootDirs;
+QString extractionCacheFile;
+int threadCount = 0;
 
 // Can't have an array of QStaticStringData<N> for different N, so
 // use QString, which requires constructor calls. Doesn't matter
@@ -189,13 +200,34 @@ QString ParserTool::transcode(const QString &str)
 
 static QString m_defaultExtensions;
 
+// Output of a job running on a worker thread, printed once it is finished
+struct JobOutput
+{
+    struct Chunk
+    {
+        bool isError;
+        QString text;
+    };
+    QList<Chunk> chunks;
+};
+
+static thread_local JobOutput *jobOutput = nullptr;
+
 static void printOut(const QString & out)
 {
+    if (jobOutput) {
+        jobOutput->chunks.append({ false, out });
+        return;
+    }
     std::cout << qPrintable(out);
 }
 
 static void printErr(const QString & out)
 {
+    if (jobOutput) {
+        jobOutput->chunks.append({ true, out });
+        return;
+    }
     std::cerr << qPrintable(out);
 }
 
@@ -249,11 +281,19 @@ static void printUsage()
         "           Default is absolute for new files.\n"
         "    -no-ui-lines\n"
         "           Do not record line numbers in references to UI files.\n"
+        "    -extraction-cache <filename>\n"
+        "           Store the strings found in C++ files in the given file, and re-use\n"
+        "           them for files which did not change since. Not used together with\n"
+        "           -clang-parser.\n"
+        "    -j <n>\n"
+        "           Use up to n threads to read source files and to update TS files.\n"
+        "           0 uses one thread per processor, which is the default.\n"
         "    -disable-heuristic {sametext|similartext|number}\n"
         "           Disable the named merge heuristic. Can be specified multiple times.\n"
         "    -project <filename>\n"
         "           Name of a file containing the project's description in JSON format.\n"
         "           Such a file may be generated from a .pro file using the lprodump tool.\n"
+        "           Use - to read it from the standard input.\n"
         "    -pro <filename>\n"
         "           Name of a .pro file. Useful for files with .pro file syntax but\n"
         "           different file suffix. Projects are recursed into and merged.\n"
@@ -329,10 +369,247 @@ static bool handleTrFunctionAliases(const QString &arg)
     return true;
 }
 
+static bool updateTsFile(const Translator &fetchedTor, const QString &fileName,
+    const QList<Translator> &aliens,
+    const QString &sourceLanguage, const QString &targetLanguage,
+    UpdateOptions options)
+{
+    QDir dir;
+    QString err;
+    QString fn = dir.relativeFilePath(fileName);
+    ConversionData cd;
+    Translator tor;
+    cd.m_sortContexts = !(options & NoSort);
+    if (QFile(fileName).exists()) {
+        if (!tor.load(fileName, cd, QLatin1String("auto"))) {
+            printErr(cd.error());
+            return false;
+        }
+        tor.resolveDuplicates();
+        cd.clearErrors();
+        if (!targetLanguage.isEmpty() && targetLanguage != tor.languageCode())
+            printErr(QStringLiteral("lupdate warning: Specified target language '%1' disagrees with"
+                            " existing file's language '%2'. Ignoring.\n")
+                     .arg(targetLanguage, tor.languageCode()));
+        if (!sourceLanguage.isEmpty() && sourceLanguage != tor.sourceLanguageCode())
+            printErr(QStringLiteral("lupdate warning: Specified source language '%1' disagrees with"
+                            " existing file's language '%2'. Ignoring.\n")
+                     .arg(sourceLanguage, tor.sourceLanguageCode()));
+        // If there is translation in the file, the language should be recognized
+        // (when the language is not recognized, plural translations are lost)
+        if (tor.translationsExist()) {
+            QLocale::Language l;
+            QLocale::Country c;
+            tor.languageAndCountry(tor.languageCode(), &l, &c);
+            QStringList forms;
+            if (!getNumerusInfo(l, c, 0, &forms, 0)) {
+                printErr(QStringLiteral("File %1 won't be updated: it contains translation but the"
+                " target language is not recognized\n").arg(fileName));
+                return true;
+            }
+        }
+    } else {
+        if (!targetLanguage.isEmpty())
+            tor.setLanguageCode(targetLanguage);
+        else
+            tor.setLanguageCode(Translator::guessLanguageCodeFromFileName(fileName));
+        if (!sourceLanguage.isEmpty())
+            tor.setSourceLanguageCode(sourceLanguage);
+    }
+    tor.makeFileNamesAbsolute(QFileInfo(fileName).absoluteDir());
+    if (options & NoLocations)
+        tor.setLocationsType(Translator::NoLocations);
+    else if (options & RelativeLocations)
+        tor.setLocationsType(Translator::RelativeLocations);
+    else if (options & AbsoluteLocations)
+        tor.setLocationsType(Translator::AbsoluteLocations);
+    if (options & Verbose)
+        printOut(QStringLiteral("Updating '%1'...\n").arg(fn));
+
+    UpdateOptions theseOptions = options;
+    if (tor.locationsType() == Translator::NoLocations) // Could be set from file
+        theseOptions |= NoLocations;
+    Translator out = merge(tor, fetchedTor, aliens, theseOptions, err);
+
+    if ((options & Verbose) && !err.isEmpty()) {
+        printOut(err);
+        err.clear();
+    }
+    if (options & PluralOnly) {
+        if (options & Verbose)
+            printOut(QStringLiteral("Stripping non plural forms in '%1'...\n").arg(fn));
+        out.stripNonPluralForms();
+    }
+    if (options & NoObsolete)
+        out.stripObsoleteMessages();
+    out.stripEmptyContexts();
+
+    out.normalizeTranslations(cd);
+    if (!cd.errors().isEmpty()) {
+        printErr(cd.error());
+        cd.clearErrors();
+    }
+    if (!out.save(fileName, cd, QLatin1String("auto"))) {
+        printErr(cd.error());
+        return false;
+    }
+    return true;
+}
+
+/*
+  Runs the updates of TS files on worker threads: the files of one project
+  are merged and saved in parallel, and the main thread can go on extracting
+  the sources of the next project meanwhile. The source parsers keep global
+  state, so the extraction itself stays on the main thread.
+
+  Updates of the same file run in the order they were queued. Their output
+  is printed in that order, too, as soon as all earlier updates are done.
+*/
+class TsUpdateQueue
+{
+public:
+    explicit TsUpdateQueue(int threadCount)
+        : m_threadCount(threadCount > 0 ? threadCount : QThread::idealThreadCount())
+    {
+    }
+
+    ~TsUpdateQueue()
+    {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cond.notify_all();
+        for (std::thread &thread : m_threads)
+            thread.join();
+    }
+
+    void enqueue(const QString &fileName, std::function<bool()> update)
+    {
+        const QString path = QFileInfo(fileName).absoluteFilePath();
+        // The XLIFF writer numbers its elements with global counters
+        if (m_threadCount <= 1 || !path.endsWith(QLatin1String(".ts"), Qt::CaseInsensitive)) {
+            wait();
+            if (!update())
+                m_failed = true;
+            return;
+        }
+        waitFor(QStringList(path));
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto job = std::make_unique<Job>();
+            job->path = path;
+            job->update = std::move(update);
+            m_jobs.push_back(std::move(job));
+            if (m_threads.size() < size_t(m_threadCount) && m_threads.size() < m_jobs.size() - m_nextJob)
+                m_threads.emplace_back(&TsUpdateQueue::work, this);
+        }
+        m_cond.notify_all();
+        printFinished();
+    }
+
+    // Waits until the pending updates of the files are done
+    void waitFor(const QStringList &fileNames)
+    {
+        if (m_jobs.empty())
+            return;
+        QSet<QString> paths;
+        for (const QString &fileName : fileNames)
+            paths.insert(QFileInfo(fileName).absoluteFilePath());
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [&] {
+                for (size_t i = m_nextOutput; i < m_jobs.size(); ++i) {
+                    if (!m_jobs[i]->done && paths.contains(m_jobs[i]->path))
+                        return false;
+                }
+                return true;
+            });
+        }
+        printFinished();
+    }
+
+    // Waits until all updates are done; returns false if any of them failed
+    bool wait()
+    {
+        if (!m_jobs.empty()) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cond.wait(lock, [&] { return m_finished == m_jobs.size(); });
+            }
+            printFinished();
+        }
+        return !m_failed;
+    }
+
+private:
+    struct Job
+    {
+        QString path;
+        std::function<bool()> update;
+        JobOutput output;
+        bool done = false;
+    };
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_cond.wait(lock, [&] { return m_stopping || m_nextJob < m_jobs.size(); });
+            if (m_nextJob == m_jobs.size())
+                return;
+            Job *job = m_jobs[m_nextJob++].get();
+            lock.unlock();
+            jobOutput = &job->output;
+            const bool ok = job->update();
+            jobOutput = nullptr;
+            job->update = nullptr; // release the translators
+            lock.lock();
+            if (!ok)
+                m_failed = true;
+            job->done = true;
+            ++m_finished;
+            m_cond.notify_all();
+        }
+    }
+
+    // Prints the output of the updates that are done and have no pending predecessors
+    void printFinished()
+    {
+        std::vector<Job *> finished;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (m_nextOutput < m_jobs.size() && m_jobs[m_nextOutput]->done)
+                finished.push_back(m_jobs[m_nextOutput++].get());
+        }
+        for (Job *job : finished) {
+            for (const JobOutput::Chunk &chunk : qAsConst(job->output.chunks)) {
+                if (chunk.isError)
+                    printErr(chunk.text);
+                else
+                    printOut(chunk.text);
+            }
+            job->output.chunks.clear();
+        }
+    }
+
+    const int m_threadCount;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<Job>> m_jobs;
+    size_t m_nextJob = 0;
+    size_t m_nextOutput = 0;
+    size_t m_finished = 0;
+    bool m_stopping = false;
+    bool m_failed = false;
+};
+
 static void updateTsFiles(const Translator &fetchedTor, const QStringList &tsFileNames,
     const QStringList &alienFiles,
     const QString &sourceLanguage, const QString &targetLanguage,
-    UpdateOptions options, bool *fail)
+    UpdateOptions options, TsUpdateQueue &updates, bool *fail)
 {
     for (int i = 0; i < fetchedTor.messageCount(); i++) {
         const TranslatorMessage &msg = fetchedTor.constMessage(i);
@@ -341,6 +618,7 @@ static void updateTsFiles(const Translator &fetchedTor, const QStringList &tsFil
                      .arg(msg.id()));
     }
 
+    updates.waitFor(alienFiles);
     QList<Translator> aliens;
     for (const QString &fileName : alienFiles) {
         ConversionData cd;
@@ -354,87 +632,14 @@ static void updateTsFiles(const Translator &fetchedTor, const QStringList &tsFil
         aliens << tor;
     }
 
-    QDir dir;
-    QString err;
     for (const QString &fileName : tsFileNames) {
-        QString fn = dir.relativeFilePath(fileName);
-        ConversionData cd;
-        Translator tor;
-        cd.m_sortContexts = !(options & NoSort);
-        if (QFile(fileName).exists()) {
-            if (!tor.load(fileName, cd, QLatin1String("auto"))) {
-                printErr(cd.error());
-                *fail = true;
-                continue;
-            }
-            tor.resolveDuplicates();
-            cd.clearErrors();
-            if (!targetLanguage.isEmpty() && targetLanguage != tor.languageCode())
-                printErr(QStringLiteral("lupdate warning: Specified target language '%1' disagrees with"
-                                " existing file's language '%2'. Ignoring.\n")
-                         .arg(targetLanguage, tor.languageCode()));
-            if (!sourceLanguage.isEmpty() && sourceLanguage != tor.sourceLanguageCode())
-                printErr(QStringLiteral("lupdate warning: Specified source language '%1' disagrees with"
-                                " existing file's language '%2'. Ignoring.\n")
-                         .arg(sourceLanguage, tor.sourceLanguageCode()));
-            // If there is translation in the file, the language should be recognized
-            // (when the language is not recognized, plural translations are lost)
-            if (tor.translationsExist()) {
-                QLocale::Language l;
-                QLocale::Country c;
-                tor.languageAndCountry(tor.languageCode(), &l, &c);
-                QStringList forms;
-                if (!getNumerusInfo(l, c, 0, &forms, 0)) {
-                    printErr(QStringLiteral("File %1 won't be updated: it contains translation but the"
-                    " target language is not recognized\n").arg(fileName));
-                    continue;
-                }
-            }
-        } else {
-            if (!targetLanguage.isEmpty())
-                tor.setLanguageCode(targetLanguage);
-            else
-                tor.setLanguageCode(Translator::guessLanguageCodeFromFileName(fileName));
-            if (!sourceLanguage.isEmpty())
-                tor.setSourceLanguageCode(sourceLanguage);
-        }
-        tor.makeFileNamesAbsolute(QFileInfo(fileName).absoluteDir());
-        if (options & NoLocations)
-            tor.setLocationsType(Translator::NoLocations);
-        else if (options & RelativeLocations)
-            tor.setLocationsType(Translator::RelativeLocations);
-        else if (options & AbsoluteLocations)
-            tor.setLocationsType(Translator::AbsoluteLocations);
-        if (options & Verbose)
-            printOut(QStringLiteral("Updating '%1'...\n").arg(fn));
-
-        UpdateOptions theseOptions = options;
-        if (tor.locationsType() == Translator::NoLocations) // Could be set from file
-            theseOptions |= NoLocations;
-        Translator out = merge(tor, fetchedTor, aliens, theseOptions, err);
-
-        if ((options & Verbose) && !err.isEmpty()) {
-            printOut(err);
-            err.clear();
-        }
-        if (options & PluralOnly) {
-            if (options & Verbose)
-                printOut(QStringLiteral("Stripping non plural forms in '%1'...\n").arg(fn));
-            out.stripNonPluralForms();
-        }
-        if (options & NoObsolete)
-            out.stripObsoleteMessages();
-        out.stripEmptyContexts();
-
-        out.normalizeTranslations(cd);
-        if (!cd.errors().isEmpty()) {
-            printErr(cd.error());
-            cd.clearErrors();
-        }
-        if (!out.save(fileName, cd, QLatin1String("auto"))) {
-            printErr(cd.error());
-            *fail = true;
-        }
+        // Each update gets its own copy of the translator, as lookups build its indexes.
+        // The copies share the messages.
+        updates.enqueue(fileName, [fetchedTor, fileName, aliens, sourceLanguage, targetLanguage,
+                                   options] {
+            return updateTsFile(fetchedTor, fileName, aliens, sourceLanguage, targetLanguage,
+                                options);
+        });
     }
 }
 
@@ -495,35 +700,125 @@ static bool processTs(Translator &fetchedTor, const QString &file, ConversionDat
     return false;
 }
 
+// A source file; for the ones loaded on worker threads, with the loader and
+// the messages extracted by it.
+struct SourceLoadJob
+{
+    QString fileName;
+    bool (*load)(Translator &, const QString &, ConversionData &) = nullptr;
+    Translator translator;
+    ConversionData cd;
+};
+
+// Adds the messages a loader put into a Translator of their own to
+// fetchedTor, as if the loader had extended fetchedTor directly.
+static void extendFetchedTor(Translator &fetchedTor, const Translator &tor, ConversionData &cd)
+{
+    bool hasContextComments = false;
+    for (const TranslatorMessage &msg : tor.messages()) {
+        // Context comments of QML files are appended, not merged.
+        if (msg.type() == TranslatorMessage::Finished) {
+            fetchedTor.append(msg);
+            hasContextComments = true;
+            continue;
+        }
+        if (fetchedTor.find(msg) == -1) {
+            fetchedTor.append(msg);
+            continue;
+        }
+        // The loader extended the message once for every location, and
+        // possibly with different comments each time.
+        const TranslatorMessage::References refs = msg.allReferences();
+        const QStringList comments = msg.extraComment().split(QLatin1String("\n----------\n"));
+        for (qsizetype i = 0; i < qMax(refs.size(), comments.size()); ++i) {
+            TranslatorMessage part = msg;
+            if (!refs.isEmpty())
+                part.setReferences({ refs.at(qMin(i, refs.size() - 1)) });
+            part.setExtraComment(i < comments.size() ? comments.at(i) : QString());
+            fetchedTor.extend(part, cd);
+        }
+    }
+    if (hasContextComments)
+        fetchedTor.setExtras(tor.extras());
+}
+
 static void processSources(Translator &fetchedTor,
                            const QStringList &sourceFiles, ConversionData &cd, bool *fail)
 {
 #ifdef QT_NO_QML
     bool requireQmlSupport = false;
 #endif
-    QStringList sourceFilesCpp;
+    std::vector<SourceLoadJob> jobs;
+    jobs.reserve(sourceFiles.size());
+    size_t loadCount = 0;
     for (const auto &sourceFile : sourceFiles) {
+        SourceLoadJob job;
+        job.fileName = sourceFile;
         if (sourceFile.endsWith(QLatin1String(".java"), Qt::CaseInsensitive))
-            loadJava(fetchedTor, sourceFile, cd);
+            job.load = loadJava;
         else if (sourceFile.endsWith(QLatin1String(".ui"), Qt::CaseInsensitive)
                  || sourceFile.endsWith(QLatin1String(".jui"), Qt::CaseInsensitive))
-            loadUI(fetchedTor, sourceFile, cd);
+            job.load = loadUI;
 #ifndef QT_NO_QML
         else if (sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
                  || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive))
-            loadQScript(fetchedTor, sourceFile, cd);
+            job.load = loadQScript;
         else if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive))
-            loadQml(fetchedTor, sourceFile, cd);
+            job.load = loadQml;
 #else
         else if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive)
                  || sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
-                 || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive))
+                 || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive)) {
             requireQmlSupport = true;
+            continue;
+        }
 #endif // QT_NO_QML
         else if (sourceFile.endsWith(u".py", Qt::CaseInsensitive))
-            loadPython(fetchedTor, sourceFile, cd);
-        else if (!processTs(fetchedTor, sourceFile, cd))
-            sourceFilesCpp << sourceFile;
+            job.load = loadPython;
+        if (job.load) {
+            job.cd = cd;
+            job.cd.clearErrors();
+            ++loadCount;
+        }
+        jobs.push_back(std::move(job));
+    }
+
+    // The alias map is built lazily; make sure this does not happen concurrently.
+    trFunctionAliasManager.nameToTrFunctionMap();
+
+    std::atomic<size_t> nextJob = 0;
+    const auto loadJobs = [&jobs, &nextJob]() {
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            SourceLoadJob &job = jobs[i];
+            if (job.load)
+                job.load(job.translator, job.fileName, job.cd);
+        }
+    };
+    const size_t threadCount = cd.m_threadCount > 0
+            ? size_t(cd.m_threadCount) : size_t(std::thread::hardware_concurrency());
+    const size_t idealThreadCount = std::min(loadCount, threadCount);
+    if (idealThreadCount > 1) {
+        std::vector<std::thread> workers;
+        workers.reserve(idealThreadCount);
+        for (size_t i = 0; i < idealThreadCount; ++i)
+            workers.emplace_back(loadJobs);
+        for (std::thread &worker : workers)
+            worker.join();
+    } else {
+        loadJobs();
+    }
+
+    // Merge in input order, so the result does not depend on the scheduling.
+    QStringList sourceFilesCpp;
+    for (SourceLoadJob &job : jobs) {
+        if (job.load) {
+            extendFetchedTor(fetchedTor, job.translator, cd);
+            for (const QString &error : job.cd.errors())
+                cd.appendError(error);
+            cd.m_sourceFileName = job.cd.m_sourceFileName;
+        } else if (!processTs(fetchedTor, job.fileName, cd)) {
+            sourceFilesCpp << job.fileName;
+        }
     }
 
 #ifdef QT_NO_QML
@@ -567,9 +862,11 @@ class ProjectProcessor
 {
 public:
     ProjectProcessor(const QString &sourceLanguage,
-                     const QString &targetLanguage)
+                     const QString &targetLanguage,
+                     TsUpdateQueue &updates)
         : m_sourceLanguage(sourceLanguage),
-          m_targetLanguage(targetLanguage)
+          m_targetLanguage(targetLanguage),
+          m_updates(updates)
     {
     }
 
@@ -615,6 +912,8 @@ private:
             cd.m_compilationDatabaseDir = prj.compileCommands;
         else
             cd.m_compilationDatabaseDir = commandLineCompilationDatabaseDir;
+        cd.m_extractionCacheFile = extractionCacheFile;
+        cd.m_threadCount = threadCount;
 
         QStringList tsFiles;
         if (prj.translations) {
@@ -638,9 +937,10 @@ private:
             }
             Translator tor;
             processProjects(false, options, prj.subProjects, false, &tor, fail);
+            m_updates.waitFor(sources);
             processSources(tor, sources, cd, fail);
             updateTsFiles(tor, tsFiles, QStringList(), m_sourceLanguage, m_targetLanguage,
-                          options, fail);
+                          options, m_updates, fail);
             return;
         }
 
@@ -652,15 +952,18 @@ private:
             }
             Translator tor;
             processProjects(false, options, prj.subProjects, nestComplain, &tor, fail);
+            m_updates.waitFor(sources);
             processSources(tor, sources, cd, fail);
         } else {
             processProjects(false, options, prj.subProjects, nestComplain, parentTor, fail);
+            m_updates.waitFor(sources);
             processSources(*parentTor, sources, cd, fail);
         }
     }
 
     QString m_sourceLanguage;
     QString m_targetLanguage;
+    TsUpdateQueue &m_updates;
 };
 
 int main(int argc, char **argv)
@@ -798,6 +1101,24 @@ int main(int argc, char **argv)
         } else if (arg == QLatin1String("-no-ui-lines")) {
             options |= NoUiLines;
             continue;
+        } else if (arg == QLatin1String("-extraction-cache")) {
+            ++i;
+            if (i == argc) {
+                printErr(u"The -extraction-cache option should be followed by a file name.\n"_s);
+                return 1;
+            }
+            extractionCacheFile = args[i];
+            continue;
+        } else if (arg == QLatin1String("-j")) {
+            ++i;
+            bool ok = false;
+            if (i < argc)
+                threadCount = args[i].toInt(&ok);
+            if (!ok || threadCount < 0) {
+                printErr(u"The -j option should be followed by a non-negative number.\n"_s);
+                return 1;
+            }
+            continue;
         } else if (arg == QLatin1String("-verbose")) {
             options |= Verbose;
             continue;
@@ -1039,6 +1360,7 @@ int main(int argc, char **argv)
     }
 
     bool fail = false;
+    TsUpdateQueue updates(threadCount);
     if (projectDescription.empty()) {
         if (tsFileNames.isEmpty())
             printErr(u"lupdate warning:"
@@ -1052,12 +1374,14 @@ int main(int argc, char **argv)
         cd.m_includePath = includePath;
         cd.m_allCSources = allCSources;
         cd.m_compilationDatabaseDir = commandLineCompilationDatabaseDir;
+        cd.m_extractionCacheFile = extractionCacheFile;
+        cd.m_threadCount = threadCount;
         cd.m_rootDirs = rootDirs;
         for (const QString &resource : qAsConst(resourceFiles))
             sourceFiles << getResources(resource);
         processSources(fetchedTor, sourceFiles, cd, &fail);
         updateTsFiles(fetchedTor, tsFileNames, alienFiles,
-                      sourceLanguage, targetLanguage, options, &fail);
+                      sourceLanguage, targetLanguage, options, updates, &fail);
     } else {
         if (!sourceFiles.isEmpty() || !resourceFiles.isEmpty() || !includePath.isEmpty()) {
             printErr(QStringLiteral("lupdate error:"
@@ -1065,19 +1389,23 @@ int main(int argc, char **argv)
             return 1;
         }
         QString errorString;
-        ProjectProcessor projectProcessor(sourceLanguage, targetLanguage);
+        ProjectProcessor projectProcessor(sourceLanguage, targetLanguage, updates);
         if (!tsFileNames.isEmpty()) {
             Translator fetchedTor;
             projectProcessor.processProjects(true, options, projectDescription, true, &fetchedTor,
                                              &fail);
+            if (!updates.wait())
+                fail = true;
             if (!fail) {
                 updateTsFiles(fetchedTor, tsFileNames, alienFiles,
-                              sourceLanguage, targetLanguage, options, &fail);
+                              sourceLanguage, targetLanguage, options, updates, &fail);
             }
         } else {
             projectProcessor.processProjects(true, options, projectDescription, false, nullptr,
                                              &fail);
         }
     }
+    if (!updates.wait())
+        fail = true;
     return fail ? 1 : 0;
 }
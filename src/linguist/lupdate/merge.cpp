@@ -420,6 +420,7 @@ Translator merge(
       Messages found only in the virgin translator are added to the
       vernacular translator.
     */
+    QList<TranslatorMessage> newMessages;
     for (const TranslatorMessage &mv : virginTor.messages()) {
         if (mv.sourceText().isEmpty() && mv.id().isEmpty()) {
             if (tor.find(mv.context()) >= 0)
@@ -440,13 +441,16 @@ Translator merge(
                 }
             }
         }
-        if (options & NoLocations)
-            outTor.append(mv);
-        else
-            outTor.appendSorted(mv);
+        newMessages.append(mv);
         if (!mv.sourceText().isEmpty() || !mv.id().isEmpty())
             ++neww;
     }
+    if (options & NoLocations) {
+        for (const TranslatorMessage &mv : qAsConst(newMessages))
+            outTor.append(mv);
+    } else {
+        outTor.appendSorted(newMessages);
+    }
 
     /*
       "Alien" translators can be used to augment the vernacular translator.
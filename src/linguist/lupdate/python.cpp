@@ -32,51 +32,84 @@ enum Token { Tok_Eof, Tok_class, Tok_return, Tok_tr,
 
 /*
   The tokenizer maintains the following global variables. The names
-  should be self-explanatory.
+  should be self-explanatory. Files are parsed on several threads at
+  once, so each thread has its own.
 */
-static QString yyFileName;
-static int yyCh;
-static QByteArray yyIdent;
-static char yyComment[65536];
-static size_t yyCommentLen;
-static char yyString[65536];
-static size_t yyStringLen;
-static int yyParenDepth;
-static int yyLineNo;
-static int yyCurLineNo;
-
-static QByteArray extraComment;
-static QByteArray id;
-
-QHash<QByteArray, Token> tokens = {
-    {"None", Tok_None},
-    {"class", Tok_class},
-    {"return", Tok_return},
-    {"__tr", Tok_tr}, // Legacy?
-    {"__trUtf8", Tok_trUtf8}
-};
+static thread_local QString yyFileName;
+static thread_local int yyCh;
+static thread_local QByteArray yyIdent;
+static thread_local QByteArray yyComment;
+static thread_local QByteArray yyString;
+static thread_local int yyParenDepth;
+static thread_local int yyLineNo;
+static thread_local int yyCurLineNo;
+
+static thread_local QByteArray extraComment;
+static thread_local QByteArray id;
+
+/*
+  The keywords and the tr function aliases. Built on first use, which may
+  happen on several threads at once, and read-only afterwards.
+*/
+static const QHash<QByteArray, Token> &tokens()
+{
+    static const QHash<QByteArray, Token> keywords = [] {
+        QHash<QByteArray, Token> result = {
+            {"None", Tok_None},
+            {"class", Tok_class},
+            {"return", Tok_return},
+            {"__tr", Tok_tr}, // Legacy?
+            {"__trUtf8", Tok_trUtf8}
+        };
+
+        // Match the function aliases to our tokens
+        const auto &nameMap = trFunctionAliasManager.nameToTrFunctionMap();
+        for (auto it = nameMap.cbegin(), end = nameMap.cend(); it != end; ++it) {
+            switch (it.value()) {
+            case TrFunctionAliasManager::Function_tr:
+            case TrFunctionAliasManager::Function_QT_TR_NOOP:
+                result.insert(it.key().toUtf8(), Tok_tr);
+                break;
+            case TrFunctionAliasManager::Function_trUtf8:
+                result.insert(it.key().toUtf8(), Tok_trUtf8);
+                break;
+            case TrFunctionAliasManager::Function_translate:
+            case TrFunctionAliasManager::Function_QT_TRANSLATE_NOOP:
+            // QTranslator::findMessage() has the same parameters as QApplication::translate().
+            case TrFunctionAliasManager::Function_findMessage:
+                result.insert(it.key().toUtf8(), Tok_translate);
+                break;
+            default:
+                break;
+            }
+        }
+        return result;
+    }();
+
+    return keywords;
+}
 
 // the file to read from (if reading from a file)
-static FILE *yyInFile;
+static thread_local FILE *yyInFile;
 
 // the string to read from and current position in the string (otherwise)
-static int yyInPos;
-static int buf;
+static thread_local int yyInPos;
+static thread_local int buf;
 
-static int (*getChar)();
-static int (*peekChar)();
+static thread_local int (*getChar)();
+static thread_local int (*peekChar)();
 
-static int yyIndentationSize;
-static int yyContinuousSpaceCount;
-static bool yyCountingIndentation;
+static thread_local int yyIndentationSize;
+static thread_local int yyContinuousSpaceCount;
+static thread_local bool yyCountingIndentation;
 
 // (Context, indentation level) pair.
 using ContextPair = QPair<QByteArray, int>;
 // Stack of (Context, indentation level) pairs.
 using ContextStack = QStack<ContextPair>;
-static ContextStack yyContextStack;
+static thread_local ContextStack yyContextStack;
 
-static int yyContextPops;
+static thread_local int yyContextPops;
 
 static int getCharFromFile()
 {
@@ -170,8 +203,7 @@ static Token parseString()
                     }
                 }
             } else if (tripleQuote) {
-                if (yyStringLen < sizeof(yyString) - 1)
-                    yyString[yyStringLen++] = char(yyCh);
+                yyString += char(yyCh);
                 yyCh = getChar();
                 continue;
             } else {
@@ -198,8 +230,7 @@ static Token parseString()
 #else
                 std::sscanf(hex, "%x", &n);
 #endif
-                if (yyStringLen < sizeof(yyString) - 1)
-                    yyString[yyStringLen++] = char(n);
+                yyString += char(n);
             } else if (yyCh >= '0' && yyCh < '8') {
                 QByteArray oct;
                 int n = 0;
@@ -214,28 +245,20 @@ static Token parseString()
 #else
                 std::sscanf(oct, "%o", &n);
 #endif
-                if (yyStringLen < sizeof(yyString) - 1)
-                    yyString[yyStringLen++] = char(n);
+                yyString += char(n);
             } else {
                 const char *p = std::strchr(tab, yyCh);
-                if (yyStringLen < sizeof(yyString) - 1) {
-                    yyString[yyStringLen++] = (p == nullptr)
-                            ? char(yyCh) : backTab[p - tab];
-                }
+                yyString += (p == nullptr) ? char(yyCh) : backTab[p - tab];
                 yyCh = getChar();
             }
         } else {
-            char *yStart = yyString + yyStringLen;
-            char *yp = yStart;
             while (yyCh != EOF && (tripleQuote || yyCh != '\n') && yyCh != quoteChar
                    && yyCh != '\\') {
-                *yp++ = char(yyCh);
+                yyString += char(yyCh);
                 yyCh = getChar();
             }
-            yyStringLen += yp - yStart;
         }
     }
-    yyString[yyStringLen] = '\0';
 
     if (yyCh != quoteChar) {
         printf("%c\n", yyCh);
@@ -265,8 +288,9 @@ static QByteArray readLine()
 static Token getToken()
 {
     yyIdent.clear();
-    yyCommentLen = 0;
-    yyStringLen = 0;
+    // Keep the capacity of the buffers, which only grow as needed
+    yyComment.truncate(0);
+    yyString.truncate(0);
     while (yyCh != EOF) {
         yyLineNo = yyCurLineNo;
 
@@ -276,7 +300,7 @@ static Token getToken()
                 yyCh = getChar();
             } while (std::isalnum(yyCh) || yyCh == '_');
 
-            return tokens.value(yyIdent, Tok_Ident);
+            return tokens().value(yyIdent, Tok_Ident);
         }
         switch (yyCh) {
         case '#':
@@ -361,7 +385,7 @@ static Token getToken()
   (3) the call appears within a function defined outside the class definition.
 */
 
-static Token yyTok;
+static thread_local Token yyTok;
 
 static bool match(Token t)
 {
@@ -677,32 +701,6 @@ static void parse(Translator &tor, ConversionData &cd,
 
 bool loadPython(Translator &translator, const QString &fileName, ConversionData &cd)
 {
-    // Match the function aliases to our tokens
-    static bool firstTime = true;
-    if (firstTime) {
-        firstTime = false;
-        const auto &nameMap  = trFunctionAliasManager.nameToTrFunctionMap();
-        for (auto it = nameMap.cbegin(), end = nameMap.cend(); it != end; ++it) {
-            switch (it.value()) {
-            case TrFunctionAliasManager::Function_tr:
-            case TrFunctionAliasManager::Function_QT_TR_NOOP:
-                tokens.insert(it.key().toUtf8(), Tok_tr);
-                break;
-            case TrFunctionAliasManager::Function_trUtf8:
-                tokens.insert(it.key().toUtf8(), Tok_trUtf8);
-                break;
-            case TrFunctionAliasManager::Function_translate:
-            case TrFunctionAliasManager::Function_QT_TRANSLATE_NOOP:
-            // QTranslator::findMessage() has the same parameters as QApplication::translate().
-            case TrFunctionAliasManager::Function_findMessage:
-                tokens.insert(it.key().toUtf8(), Tok_translate);
-                break;
-            default:
-                break;
-            }
-        }
-    }
-
 #ifdef Q_CC_MSVC
     const auto *fileNameC = reinterpret_cast<const wchar_t *>(fileName.utf16());
     const bool ok = _wfopen_s(&yyInFile, fileNameC, L"r") == 0;
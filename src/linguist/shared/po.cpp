@@ -11,7 +11,10 @@
 #include <QtCore/QStringConverter>
 #include <QtCore/QTextStream>
 
+#include <algorithm>
+
 #include <ctype.h>
+#include <string.h>
 
 // Uncomment if you wish to hard wrap long lines in .po files. Note that this
 // affects only msg strings, not comments.
@@ -181,6 +184,12 @@ public:
 };
 
 
+// Same as QByteArray::trimmed()
+static inline bool isAsciiSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
 static bool isTranslationLine(const QByteArray &line)
 {
     return line.startsWith("#~ msgstr") || line.startsWith("msgstr");
@@ -196,9 +205,10 @@ static QByteArray slurpEscapedString(const QList<QByteArray> &lines, int &l,
         const QByteArray &line = lines.at(l);
         if (line.isEmpty() || !line.startsWith(prefix))
             break;
-        while (isspace(line[offset])) // No length check, as string has no trailing spaces.
+        // The lines point into the input and are not null-terminated.
+        while (offset >= 0 && offset < line.length() && isspace(line[offset]))
             offset++;
-        if (line[offset] != '"')
+        if (offset < 0 || offset >= line.length() || line[offset] != '"')
             break;
         offset++;
         forever {
@@ -393,10 +403,24 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
     // msgstr[0] translated-string
     // ...
 
-    // we need line based lookahead below.
+    // we need line based lookahead below. The lines are trimmed raw views
+    // of the input; only the strings going into the messages are copied.
+    const DeviceData input(dev);
+    const char *pos = input.data();
+    const char *const end = pos + input.size();
     QList<QByteArray> lines;
-    while (!dev.atEnd())
-        lines.append(dev.readLine().trimmed());
+    lines.reserve(std::count(pos, end, '\n') + 2);
+    while (pos != end) {
+        const char *eol = static_cast<const char *>(memchr(pos, '\n', end - pos));
+        const char *next = eol ? eol + 1 : end;
+        const char *lineEnd = eol ? eol : end;
+        while (pos != lineEnd && isAsciiSpace(*pos))
+            ++pos;
+        while (lineEnd != pos && isAsciiSpace(lineEnd[-1]))
+            --lineEnd;
+        lines.append(QByteArray::fromRawData(pos, lineEnd - pos));
+        pos = next;
+    }
     lines.append(QByteArray());
 
     int l = 0, lastCmtLine = -1;
@@ -11,6 +11,7 @@
 #include <QtCore/qset.h>
 
 #include <algorithm>
+#include <cstdio>
 #include <functional>
 
 using std::placeholders::_1;
@@ -82,8 +83,16 @@ private:
 static QJsonArray readRawProjectDescription(const QString &filePath, QString *errorString)
 {
     errorString->clear();
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly)) {
+    QFile file;
+    bool opened;
+    if (filePath == QLatin1String("-")) {
+        // lupdate-pro and lrelease-pro pass the description through standard input
+        opened = file.open(stdin, QIODevice::ReadOnly);
+    } else {
+        file.setFileName(filePath);
+        opened = file.open(QIODevice::ReadOnly);
+    }
+    if (!opened) {
         *errorString = FMT::tr("Cannot open project description file '%1'.\n")
             .arg(filePath);
         return {};
@@ -0,0 +1,473 @@
+// Copyright (C) 2018 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "projectdump.h"
+
+#include <profileevaluator.h>
+#include <profileutils.h>
+#include <qmakeparser.h>
+#include <qmakevfs.h>
+#include <qrcreader.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFileInfo>
+#include <QtCore/QLibraryInfo>
+#include <QtCore/QMutex>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace Qt::StringLiterals;
+
+static void printErr(const QString &out)
+{
+    std::cerr << qPrintable(out);
+}
+
+static QJsonValue toJsonValue(const QJsonValue &v)
+{
+    return v;
+}
+
+static QJsonValue toJsonValue(const QString &s)
+{
+    return QJsonValue(s);
+}
+
+static QJsonValue toJsonValue(const QStringList &lst)
+{
+    return QJsonArray::fromStringList(lst);
+}
+
+template <class T>
+void setValue(QJsonObject &obj, const char *key, T value)
+{
+    obj[QLatin1String(key)] = toJsonValue(value);
+}
+
+static void print(const QString &fileName, int lineNo, const QString &msg)
+{
+    if (lineNo > 0)
+        printErr(QString::fromLatin1("WARNING: %1:%2: %3\n").arg(fileName, QString::number(lineNo), msg));
+    else if (lineNo)
+        printErr(QString::fromLatin1("WARNING: %1: %2\n").arg(fileName, msg));
+    else
+        printErr(QString::fromLatin1("WARNING: %1\n").arg(msg));
+}
+
+class EvalHandler : public QMakeHandler {
+public:
+    void message(int type, const QString &msg, const QString &fileName, int lineNo) override
+    {
+        if (verbose && !(type & CumulativeEvalMessage) && (type & CategoryMask) == ErrorMessage) {
+            QMutexLocker locker(&mutex);
+            print(fileName, lineNo, msg);
+        }
+    }
+
+    void fileMessage(int type, const QString &msg) override
+    {
+        if (verbose && !(type & CumulativeEvalMessage) && (type & CategoryMask) == ErrorMessage) {
+            // "Downgrade" errors, as we don't really care for them
+            QMutexLocker locker(&mutex);
+            printErr(QLatin1String("WARNING: ") + msg + QLatin1Char('\n'));
+        }
+    }
+
+    void aboutToEval(ProFile *, ProFile *, EvalFileType) override {}
+    void doneWithEval(ProFile *) override {}
+
+    bool verbose = true;
+
+private:
+    // Subprojects report from several threads at once
+    QMutex mutex;
+};
+
+static EvalHandler evalHandler;
+
+/*
+  What the evaluation of all projects shares. The parser and evaluator state
+  is per project; the globals, the VFS and the cache of parsed files (which
+  spares re-parsing the features and .pri files every project loads) are
+  thread-safe and shared between the threads evaluating subprojects.
+*/
+struct DumpContext
+{
+    const QStringList &translationsVariables;
+    ProFileGlobals *option;
+    QMakeVfs *vfs;
+    ProFileCache *cache;
+};
+
+static bool isSupportedExtension(const QString &ext)
+{
+    return ext == QLatin1String("qml")
+        || ext == QLatin1String("js") || ext == QLatin1String("qs")
+        || ext == QLatin1String("ui") || ext == QLatin1String("jui");
+}
+
+static QStringList getResources(const QString &resourceFile, QMakeVfs *vfs)
+{
+    Q_ASSERT(vfs);
+    if (!vfs->exists(resourceFile, QMakeVfs::VfsCumulative))
+        return QStringList();
+    QString content;
+    QString errStr;
+    if (vfs->readFile(vfs->idForFileName(resourceFile, QMakeVfs::VfsCumulative),
+                      &content, &errStr) != QMakeVfs::ReadOk) {
+        printErr(QStringLiteral("lprodump error: Cannot read %1: %2\n").arg(resourceFile, errStr));
+        return QStringList();
+    }
+    const ReadQrcResult rqr = readQrcFile(resourceFile, content);
+    if (rqr.hasError()) {
+        printErr(QStringLiteral("lprodump error: %1:%2: %3\n")
+                 .arg(resourceFile, QString::number(rqr.line), rqr.errorString));
+    }
+    return rqr.files;
+}
+
+static QStringList getSources(const char *var, const char *vvar, const QStringList &baseVPaths,
+                              const QString &projectDir, const ProFileEvaluator &visitor)
+{
+    QStringList vPaths = visitor.absolutePathValues(QLatin1String(vvar), projectDir);
+    vPaths += baseVPaths;
+    vPaths.removeDuplicates();
+    return visitor.absoluteFileValues(QLatin1String(var), projectDir, vPaths, 0);
+}
+
+static QStringList getSources(const ProFileEvaluator &visitor, const QString &projectDir,
+                              const QStringList &excludes, QMakeVfs *vfs)
+{
+    QStringList baseVPaths;
+    baseVPaths += visitor.absolutePathValues(QLatin1String("VPATH"), projectDir);
+    baseVPaths << projectDir; // QMAKE_ABSOLUTE_SOURCE_PATH
+    baseVPaths.removeDuplicates();
+
+    QStringList sourceFiles;
+
+    // app/lib template
+    sourceFiles += getSources("SOURCES", "VPATH_SOURCES", baseVPaths, projectDir, visitor);
+    sourceFiles += getSources("HEADERS", "VPATH_HEADERS", baseVPaths, projectDir, visitor);
+
+    sourceFiles += getSources("FORMS", "VPATH_FORMS", baseVPaths, projectDir, visitor);
+
+    const QStringList resourceFiles = getSources("RESOURCES", "VPATH_RESOURCES", baseVPaths, projectDir, visitor);
+    for (const QString &resource : resourceFiles)
+        sourceFiles += getResources(resource, vfs);
+
+    QStringList installs = visitor.values(QLatin1String("INSTALLS"))
+                         + visitor.values(QLatin1String("DEPLOYMENT"));
+    installs.removeDuplicates();
+    QDir baseDir(projectDir);
+    for (const QString &inst : qAsConst(installs)) {
+        for (const QString &file : visitor.values(inst + QLatin1String(".files"))) {
+            QFileInfo info(file);
+            if (!info.isAbsolute())
+                info.setFile(baseDir.absoluteFilePath(file));
+            QStringList nameFilter;
+            QString searchPath;
+            if (info.isDir()) {
+                nameFilter << QLatin1String("*");
+                searchPath = info.filePath();
+            } else {
+                nameFilter << info.fileName();
+                searchPath = info.path();
+            }
+
+            QDirIterator iterator(searchPath, nameFilter,
+                                  QDir::Files | QDir::NoDotAndDotDot | QDir::NoSymLinks,
+                                  QDirIterator::Subdirectories);
+            while (iterator.hasNext()) {
+                iterator.next();
+                QFileInfo cfi = iterator.fileInfo();
+                if (isSupportedExtension(cfi.suffix()))
+                    sourceFiles << cfi.filePath();
+            }
+        }
+    }
+
+    sourceFiles.removeDuplicates();
+    sourceFiles.sort();
+
+    for (const QString &ex : excludes) {
+        // TODO: take advantage of the file list being sorted
+        QRegularExpression rx(QRegularExpression::wildcardToRegularExpression(ex));
+        for (auto it = sourceFiles.begin(); it != sourceFiles.end(); ) {
+            if (rx.match(*it).hasMatch())
+                it = sourceFiles.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    return sourceFiles;
+}
+
+static QStringList getExcludes(const ProFileEvaluator &visitor, const QString &projectDirPath)
+{
+    const QStringList trExcludes = visitor.values(QLatin1String("TR_EXCLUDE"));
+    QStringList excludes;
+    excludes.reserve(trExcludes.size());
+    const QDir projectDir(projectDirPath);
+    for (const QString &ex : trExcludes)
+        excludes << QDir::cleanPath(projectDir.absoluteFilePath(ex));
+    return excludes;
+}
+
+static void excludeProjects(const ProFileEvaluator &visitor, QStringList *subProjects)
+{
+    for (const QString &ex : visitor.values(QLatin1String("TR_EXCLUDE"))) {
+        QRegularExpression rx(QRegularExpression::wildcardToRegularExpression(ex));
+        for (auto it = subProjects->begin(); it != subProjects->end(); ) {
+            if (rx.match(*it).hasMatch())
+                it = subProjects->erase(it);
+            else
+                ++it;
+        }
+    }
+}
+
+static QJsonArray processSubProjects(const QStringList &subProFiles, const DumpContext &ctx);
+
+static QJsonObject processProject(const QString &proFile, const DumpContext &ctx,
+                                  ProFileEvaluator &visitor)
+{
+    QJsonObject result;
+    QStringList tmp = visitor.values(QLatin1String("CODECFORSRC"));
+    if (!tmp.isEmpty())
+        result[QStringLiteral("codec")] = tmp.last();
+    QString proPath = QFileInfo(proFile).path();
+    if (visitor.templateType() == ProFileEvaluator::TT_Subdirs) {
+        QStringList subProjects = visitor.values(QLatin1String("SUBDIRS"));
+        excludeProjects(visitor, &subProjects);
+        QStringList subProFiles;
+        QDir proDir(proPath);
+        for (const QString &subdir : qAsConst(subProjects)) {
+            QString realdir = visitor.value(subdir + QLatin1String(".subdir"));
+            if (realdir.isEmpty())
+                realdir = visitor.value(subdir + QLatin1String(".file"));
+            if (realdir.isEmpty())
+                realdir = subdir;
+            QString subPro = QDir::cleanPath(proDir.absoluteFilePath(realdir));
+            QFileInfo subInfo(subPro);
+            if (subInfo.isDir()) {
+                subProFiles << (subPro + QLatin1Char('/')
+                                + subInfo.fileName() + QLatin1String(".pro"));
+            } else {
+                subProFiles << subPro;
+            }
+        }
+        QJsonArray subResults = processSubProjects(subProFiles, ctx);
+        if (!subResults.isEmpty())
+            setValue(result, "subProjects", subResults);
+    } else {
+        const QStringList excludes = getExcludes(visitor, proPath);
+        const QStringList sourceFiles = getSources(visitor, proPath, excludes, ctx.vfs);
+        setValue(result, "includePaths",
+                 visitor.absolutePathValues(QLatin1String("INCLUDEPATH"), proPath));
+        setValue(result, "excluded", excludes);
+        setValue(result, "sources", sourceFiles);
+    }
+    return result;
+}
+
+static bool processProjectFile(bool topLevel, const QString &proFile, const DumpContext &ctx,
+                               QJsonObject *result)
+{
+    // The parser keeps the state of the file being parsed, so it is not shared
+    QMakeParser parser(ctx.cache, ctx.vfs, &evalHandler);
+    ProFile *pro;
+    if (!(pro = parser.parsedProFile(proFile, topLevel ? QMakeParser::ParseReportMissing
+                                                       : QMakeParser::ParseUseCache))) {
+        return false;
+    }
+    ProFileEvaluator visitor(ctx.option, &parser, ctx.vfs, &evalHandler);
+    visitor.setCumulative(true);
+    visitor.setOutputDir(ctx.option->shadowedPath(pro->directoryName()));
+    if (!visitor.accept(pro)) {
+        pro->deref();
+        return false;
+    }
+
+    QJsonObject prj = processProject(proFile, ctx, visitor);
+    setValue(prj, "projectFile", proFile);
+    QStringList tsFiles;
+    for (const QString &varName : ctx.translationsVariables) {
+        if (!visitor.contains(varName))
+            continue;
+        QDir proDir(QFileInfo(proFile).path());
+        const QStringList translations = visitor.values(varName);
+        for (const QString &tsFile : translations)
+            tsFiles << proDir.filePath(tsFile);
+    }
+    if (!tsFiles.isEmpty())
+        setValue(prj, "translations", tsFiles);
+    if (visitor.contains(QLatin1String("LUPDATE_COMPILE_COMMANDS_PATH"))) {
+        const QStringList thepathjson = visitor.values(
+            QLatin1String("LUPDATE_COMPILE_COMMANDS_PATH"));
+        setValue(prj, "compileCommands", thepathjson.value(0));
+    }
+    *result = prj;
+    pro->deref();
+    return true;
+}
+
+static QJsonArray processSubProjects(const QStringList &subProFiles, const DumpContext &ctx)
+{
+    const int count = subProFiles.size();
+    std::vector<QJsonObject> projects(count);
+    std::vector<char> ok(count, false);
+    QSemaphore done;
+    QThreadPool *pool = QThreadPool::globalInstance();
+
+    // The first subproject is evaluated on this thread, the others on the pool
+    for (int i = 1; i < count; ++i) {
+        pool->start([&, i] {
+            ok[i] = processProjectFile(false, subProFiles.at(i), ctx, &projects[i]);
+            done.release();
+        });
+    }
+    if (count)
+        ok[0] = processProjectFile(false, subProFiles.first(), ctx, &projects[0]);
+    if (count > 1) {
+        // Hand our slot to the pool while waiting, like the evaluator does while it
+        // waits for a base environment, so that nested SUBDIRS cannot starve it.
+        pool->releaseThread();
+        done.acquire(count - 1);
+        pool->reserveThread();
+    }
+
+    QJsonArray result;
+    for (int i = 0; i < count; ++i) {
+        if (ok[i])
+            result.append(projects[i]);
+    }
+    return result;
+}
+
+bool parseProjectDumpArgument(const QStringList &args, int *i, ProjectDumpOptions *options,
+                              QString *errorString)
+{
+    const QString &arg = args.at(*i);
+    if (options->outDir.isEmpty())
+        options->outDir = QDir::currentPath();
+    if (arg == QLatin1String("-silent")) {
+        options->verbose = false;
+    } else if (arg == QLatin1String("-pro-debug")) {
+        options->proDebug++;
+    } else if (arg == QLatin1String("-pro")) {
+        if (++*i == args.size()) {
+            *errorString = QStringLiteral("The -pro option should be followed by a filename of .pro file.\n");
+            return false;
+        }
+        QString file = QDir::cleanPath(QFileInfo(args.at(*i)).absoluteFilePath());
+        options->proFiles += file;
+        options->outDirMap[file] = options->outDir;
+    } else if (arg == QLatin1String("-pro-out")) {
+        if (++*i == args.size()) {
+            *errorString = QStringLiteral("The -pro-out option should be followed by a directory name.\n");
+            return false;
+        }
+        options->outDir = QDir::cleanPath(QFileInfo(args.at(*i)).absoluteFilePath());
+    } else if (arg == u"-translations-variables"_s) {
+        if (++*i == args.size()) {
+            *errorString = u"The -translations-variables option must be followed by a "_s
+                           u"comma-separated list of variable names.\n"_s;
+            return false;
+        }
+        options->translationsVariables = args.at(*i).split(QLatin1Char(','));
+    } else if (arg.startsWith(QLatin1String("-")) && arg != QLatin1String("-")) {
+        return false;
+    } else {
+        QFileInfo fi(arg);
+        if (!fi.exists()) {
+            *errorString = QStringLiteral("lprodump error: File '%1' does not exist.\n").arg(arg);
+            return false;
+        }
+        if (!isProOrPriFile(arg)) {
+            *errorString = QStringLiteral("lprodump error: '%1' is neither a .pro nor a .pri file.\n")
+                           .arg(arg);
+            return false;
+        }
+        QString cleanFile = QDir::cleanPath(fi.absoluteFilePath());
+        options->proFiles << cleanFile;
+        options->outDirMap[cleanFile] = options->outDir;
+    }
+    return true;
+}
+
+bool dumpProjects(const ProjectDumpOptions &options, QByteArray *description)
+{
+    evalHandler.verbose = options.verbose;
+
+    ProFileGlobals option;
+    option.qmake_abslocation = QString::fromLocal8Bit(qgetenv("QMAKE"));
+    if (option.qmake_abslocation.isEmpty()) {
+        option.qmake_abslocation = QLibraryInfo::path(QLibraryInfo::BinariesPath)
+            + QLatin1String("/qmake");
+    }
+    option.debugLevel = options.proDebug;
+    option.initProperties();
+    option.setCommandLineArguments(QDir::currentPath(),
+                                   QStringList() << QLatin1String("CONFIG+=lupdate_run"));
+    QMakeVfs vfs;
+    ProFileCache cache;
+    DumpContext ctx{ options.translationsVariables, &option, &vfs, &cache };
+
+    // Must happen before any evaluation is started on the pool
+    QMakeParser::initialize();
+    ProFileEvaluator::initialize();
+
+    // This thread evaluates projects, too, so it takes one of the pool's slots
+    QThreadPool *pool = QThreadPool::globalInstance();
+    pool->reserveThread();
+
+    // The top-level projects may have different output directories, so they are
+    // evaluated one after the other; only their subprojects run concurrently.
+    bool fail = false;
+    QJsonArray results;
+    for (const QString &proFile : options.proFiles) {
+        option.setDirectories(QFileInfo(proFile).path(), options.outDirMap.value(proFile));
+        QJsonObject prj;
+        if (processProjectFile(true, proFile, ctx, &prj))
+            results.append(prj);
+        else
+            fail = true;
+    }
+
+    pool->releaseThread();
+    if (fail)
+        return false;
+
+    *description = QJsonDocument(results).toJson(QJsonDocument::Compact);
+    return true;
+}
+
+QByteArray createProjectDescription(const QStringList &args)
+{
+    ProjectDumpOptions options;
+    QString errorString;
+    for (int i = 0; i < args.size(); ++i) {
+        if (!parseProjectDumpArgument(args, &i, &options, &errorString)) {
+            if (errorString.isEmpty())
+                errorString = QStringLiteral("Unrecognized option '%1'.\n").arg(args.at(i));
+            printErr(errorString);
+            exit(1);
+        }
+    }
+
+    QByteArray description;
+    if (!dumpProjects(options, &description))
+        exit(1);
+    return description;
+}
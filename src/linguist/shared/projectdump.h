@@ -0,0 +1,36 @@
+// Copyright (C) 2018 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef PROJECTDUMP_H
+#define PROJECTDUMP_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+struct ProjectDumpOptions
+{
+    QStringList proFiles;
+    QHash<QString, QString> outDirMap;
+    QString outDir;
+    QStringList translationsVariables = { QStringLiteral("TRANSLATIONS") };
+    int proDebug = 0;
+    bool verbose = true;
+};
+
+// Consumes args[*i] (and its parameter) if it is a project file or one of the
+// options controlling the evaluation. Returns false for anything else; errorString
+// is set if the argument was recognized but is invalid.
+bool parseProjectDumpArgument(const QStringList &args, int *i, ProjectDumpOptions *options,
+                              QString *errorString);
+
+// Evaluates the projects and returns their description in the JSON format
+// understood by readProjectDescription(). Subprojects are evaluated concurrently.
+bool dumpProjects(const ProjectDumpOptions &options, QByteArray *description);
+
+// Evaluates the projects given by lprodump-style arguments in-process.
+// Exits the application if that fails.
+QByteArray createProjectDescription(const QStringList &args);
+
+#endif // PROJECTDUMP_H
@@ -11,9 +11,12 @@
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
-#include <QtCore/QMap>
+#include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QStringDecoder>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
@@ -49,25 +52,78 @@ enum Prefix {
 
 } // namespace anon
 
+// Feeds ba into the hash h up to its first NUL. Returns false if there was one.
+static bool elfHashAdd(uint &h, const QByteArray &ba)
+{
+    for (const uchar *k = (const uchar *)ba.constData(), *end = k + ba.size(); k != end; ++k) {
+        if (!*k)
+            return false;
+        h = (h << 4) + *k;
+        uint g = h & 0xf0000000;
+        if (g != 0)
+            h ^= g >> 24;
+        h &= ~g;
+    }
+    return true;
+}
+
 static uint elfHash(const QByteArray &ba)
 {
-    const uchar *k = (const uchar *)ba.data();
     uint h = 0;
-    uint g;
-
-    if (k) {
-        while (*k) {
-            h = (h << 4) + *k++;
-            if ((g = (h & 0xf0000000)) != 0)
-                h ^= g >> 24;
-            h &= ~g;
-        }
-    }
+    elfHashAdd(h, ba);
     if (!h)
         h = 1;
     return h;
 }
 
+// Same as elfHash(ba1 + ba2), without building the concatenation.
+static uint elfHash(const QByteArray &ba1, const QByteArray &ba2)
+{
+    uint h = 0;
+    if (elfHashAdd(h, ba1))
+        elfHashAdd(h, ba2);
+    if (!h)
+        h = 1;
+    return h;
+}
+
+// QDataStream compatible serialization, big endian.
+static void appendQuint16(QByteArray &out, quint16 value)
+{
+    char buf[sizeof(value)];
+    qToBigEndian(value, buf);
+    out.append(buf, sizeof(buf));
+}
+
+static void appendQuint32(QByteArray &out, quint32 value)
+{
+    char buf[sizeof(value)];
+    qToBigEndian(value, buf);
+    out.append(buf, sizeof(buf));
+}
+
+static void appendByteArray(QByteArray &out, const QByteArray &ba)
+{
+    if (ba.isNull()) {
+        appendQuint32(out, 0xffffffff);
+        return;
+    }
+    appendQuint32(out, quint32(ba.size()));
+    out.append(ba);
+}
+
+static void appendString(QByteArray &out, const QString &str)
+{
+    if (str.isNull()) {
+        appendQuint32(out, 0xffffffff);
+        return;
+    }
+    appendQuint32(out, quint32(str.size() * 2));
+    const qsizetype pos = out.size();
+    out.resize(pos + str.size() * 2);
+    qToBigEndian<quint16>(str.utf16(), str.size(), out.data() + pos);
+}
+
 class ByteTranslatorMessage
 {
 public:
@@ -86,6 +142,11 @@ public:
     const QByteArray &comment() const { return m_comment; }
     const QStringList &translations() const { return m_translations; }
     bool operator<(const ByteTranslatorMessage& m) const;
+    bool operator==(const ByteTranslatorMessage &m) const
+    {
+        return m_context == m.m_context && m_sourcetext == m.m_sourcetext
+                && m_comment == m.m_comment;
+    }
 
 private:
     QByteArray m_context;
@@ -96,6 +157,12 @@ private:
 
 Q_DECLARE_TYPEINFO(ByteTranslatorMessage, Q_RELOCATABLE_TYPE);
 
+// Like the ordering, this ignores the translations.
+static size_t qHash(const ByteTranslatorMessage &msg, size_t seed = 0) noexcept
+{
+    return qHashMulti(seed, msg.context(), msg.sourceText(), msg.comment());
+}
+
 bool ByteTranslatorMessage::operator<(const ByteTranslatorMessage& m) const
 {
     if (m_context != m.m_context)
@@ -147,11 +214,13 @@ private:
     // on turn should be the same as passed to the actual tr(...) calls
     QByteArray originalBytes(const QString &str) const;
 
-    static Prefix commonPrefix(const ByteTranslatorMessage &m1, const ByteTranslatorMessage &m2);
+    static Prefix commonPrefix(const ByteTranslatorMessage &m1, uint hash1,
+                               const ByteTranslatorMessage &m2, uint hash2);
 
     static uint msgHash(const ByteTranslatorMessage &msg);
 
-    void writeMessage(const ByteTranslatorMessage & msg, QDataStream & stream,
+    static qsizetype maxMessageSize(const ByteTranslatorMessage &msg);
+    void writeMessage(const ByteTranslatorMessage & msg, QByteArray & out,
         TranslatorSaveMode strip, Prefix prefix) const;
 
     QString m_language;
@@ -159,7 +228,8 @@ private:
     QByteArray m_messageArray;
     QByteArray m_offsetArray;
     QByteArray m_contextArray;
-    QMap<ByteTranslatorMessage, void *> m_messages;
+    // The first message inserted with a given key wins.
+    QSet<ByteTranslatorMessage> m_messages;
     QByteArray m_numerusRules;
     QStringList m_dependencies;
     QByteArray m_dependencyArray;
@@ -177,12 +247,13 @@ QByteArray Releaser::originalBytes(const QString &str) const
 
 uint Releaser::msgHash(const ByteTranslatorMessage &msg)
 {
-    return elfHash(msg.sourceText() + msg.comment());
+    return elfHash(msg.sourceText(), msg.comment());
 }
 
-Prefix Releaser::commonPrefix(const ByteTranslatorMessage &m1, const ByteTranslatorMessage &m2)
+Prefix Releaser::commonPrefix(const ByteTranslatorMessage &m1, uint hash1,
+                              const ByteTranslatorMessage &m2, uint hash2)
 {
-    if (msgHash(m1) != msgHash(m2))
+    if (hash1 != hash2)
         return NoPrefix;
     if (m1.context() != m2.context())
         return Hash;
@@ -193,11 +264,23 @@ Prefix Releaser::commonPrefix(const ByteTranslatorMessage &m1, const ByteTransla
     return HashContextSourceTextComment;
 }
 
-void Releaser::writeMessage(const ByteTranslatorMessage &msg, QDataStream &stream,
+// An upper bound of what writeMessage() produces, for reserving the message array.
+qsizetype Releaser::maxMessageSize(const ByteTranslatorMessage &msg)
+{
+    qsizetype size = 1 + 3 * 5 + msg.context().size() + msg.sourceText().size()
+            + msg.comment().size();
+    for (const QString &translation : msg.translations())
+        size += 5 + 2 * translation.size();
+    return size;
+}
+
+void Releaser::writeMessage(const ByteTranslatorMessage &msg, QByteArray &out,
     TranslatorSaveMode mode, Prefix prefix) const
 {
-    for (int i = 0; i < msg.translations().count(); ++i)
-        stream << quint8(Tag_Translation) << msg.translations().at(i);
+    for (const QString &translation : msg.translations()) {
+        out.append(char(Tag_Translation));
+        appendString(out, translation);
+    }
 
     if (mode == SaveEverything)
         prefix = HashContextSourceTextComment;
@@ -206,17 +289,20 @@ void Releaser::writeMessage(const ByteTranslatorMessage &msg, QDataStream &strea
     switch (prefix) {
     default:
     case HashContextSourceTextComment:
-        stream << quint8(Tag_Comment) << msg.comment();
+        out.append(char(Tag_Comment));
+        appendByteArray(out, msg.comment());
         Q_FALLTHROUGH();
     case HashContextSourceText:
-        stream << quint8(Tag_SourceText) << msg.sourceText();
+        out.append(char(Tag_SourceText));
+        appendByteArray(out, msg.sourceText());
         Q_FALLTHROUGH();
     case HashContext:
-        stream << quint8(Tag_Context) << msg.context();
+        out.append(char(Tag_Context));
+        appendByteArray(out, msg.context());
         break;
     }
 
-    stream << quint8(Tag_End);
+    out.append(char(Tag_End));
 }
 
 
@@ -269,7 +355,10 @@ void Releaser::squeeze(TranslatorSaveMode mode)
     if (m_messages.isEmpty() && mode == SaveEverything)
         return;
 
-    const auto messages = m_messages;
+    // A single sort brings the messages into the order of the file, which
+    // also groups them by context.
+    QList<ByteTranslatorMessage> messages(m_messages.cbegin(), m_messages.cend());
+    std::sort(messages.begin(), messages.end());
 
     // re-build contents
     m_messageArray.clear();
@@ -277,45 +366,61 @@ void Releaser::squeeze(TranslatorSaveMode mode)
     m_contextArray.clear();
     m_messages.clear();
 
-    QMap<Offset, void *> offsets;
+    const int count = messages.size();
+    QList<uint> hashes;
+    hashes.reserve(count);
+    qsizetype messageArraySize = 0;
+    for (const ByteTranslatorMessage &msg : qAsConst(messages)) {
+        hashes.append(msgHash(msg));
+        messageArraySize += maxMessageSize(msg);
+    }
 
-    QDataStream ms(&m_messageArray, QIODevice::WriteOnly);
+    QList<Offset> offsets;
+    offsets.reserve(count);
+    m_messageArray.reserve(messageArraySize);
     int cpPrev = 0, cpNext = 0;
-    for (auto it = messages.cbegin(), end = messages.cend(); it != end; ++it) {
+    for (int i = 0; i < count; ++i) {
         cpPrev = cpNext;
-        const auto next = std::next(it);
-        if (next == end)
+        if (i + 1 == count)
             cpNext = 0;
         else
-            cpNext = commonPrefix(it.key(), next.key());
-        offsets.insert(Offset(msgHash(it.key()), ms.device()->pos()), (void *)0);
-        writeMessage(it.key(), ms, mode, Prefix(qMax(cpPrev, cpNext + 1)));
+            cpNext = commonPrefix(messages.at(i), hashes.at(i), messages.at(i + 1), hashes.at(i + 1));
+        offsets.append(Offset(hashes.at(i), uint(m_messageArray.size())));
+        writeMessage(messages.at(i), m_messageArray, mode, Prefix(qMax(cpPrev, cpNext + 1)));
     }
 
-    auto offset = offsets.cbegin();
-    QDataStream ds(&m_offsetArray, QIODevice::WriteOnly);
-    while (offset != offsets.cend()) {
-        Offset k = offset.key();
-        ++offset;
-        ds << quint32(k.h) << quint32(k.o);
+    std::sort(offsets.begin(), offsets.end());
+    m_offsetArray.reserve(count * 2 * sizeof(quint32));
+    for (const Offset &offset : qAsConst(offsets)) {
+        appendQuint32(m_offsetArray, offset.h);
+        appendQuint32(m_offsetArray, offset.o);
     }
 
     if (mode == SaveStripped) {
-        QMap<QByteArray, int> contextSet;
-        for (auto it = messages.cbegin(), end = messages.cend(); it != end; ++it)
-            ++contextSet[it.key().context()];
+        QList<QByteArray> contexts;
+        for (const ByteTranslatorMessage &msg : qAsConst(messages)) {
+            if (contexts.isEmpty() || contexts.constLast() != msg.context())
+                contexts.append(msg.context());
+        }
 
         quint16 hTableSize;
-        if (contextSet.size() < 200)
-            hTableSize = (contextSet.size() < 60) ? 151 : 503;
-        else if (contextSet.size() < 2500)
-            hTableSize = (contextSet.size() < 750) ? 1511 : 5003;
+        if (contexts.size() < 200)
+            hTableSize = (contexts.size() < 60) ? 151 : 503;
+        else if (contexts.size() < 2500)
+            hTableSize = (contexts.size() < 750) ? 1511 : 5003;
         else
-            hTableSize = (contextSet.size() < 10000) ? 15013 : 3 * contextSet.size() / 2;
-
-        QMultiMap<int, QByteArray> hashMap;
-        for (auto c = contextSet.cbegin(), end = contextSet.cend(); c != end; ++c)
-            hashMap.insert(elfHash(c.key()) % hTableSize, c.key());
+            hTableSize = (contexts.size() < 10000) ? 15013 : 3 * contexts.size() / 2;
+
+        // Pairs of hash table slot and index into contexts. Contexts sharing a
+        // slot are stored in descending order, as older versions did.
+        QList<std::pair<int, int>> entries;
+        entries.reserve(contexts.size());
+        for (int i = 0; i < contexts.size(); ++i)
+            entries.append({ int(elfHash(contexts.at(i)) % hTableSize), i });
+        std::sort(entries.begin(), entries.end(),
+                  [](const std::pair<int, int> &e1, const std::pair<int, int> &e2) {
+                      return e1.first != e2.first ? e1.first < e2.first : e1.second > e2.second;
+                  });
 
         /*
           The contexts found in this translator are stored in a hash
@@ -339,45 +444,40 @@ void Releaser::squeeze(TranslatorSaveMode mode)
           contexts stored there, until we find it or we meet the
           empty string.
         */
-        m_contextArray.resize(2 + (hTableSize << 1));
-        QDataStream t(&m_contextArray, QIODevice::WriteOnly);
-
-        quint16 *hTable = new quint16[hTableSize];
-        memset(hTable, 0, hTableSize * sizeof(quint16));
-
-        t << hTableSize;
-        t.device()->seek(2 + (hTableSize << 1));
-        t << quint16(0); // the entry at offset 0 cannot be used
+        QList<quint16> hTable(hTableSize, 0);
+        QByteArray contextPool;
+        appendQuint16(contextPool, 0); // the entry at offset 0 cannot be used
         uint upto = 2;
 
-        auto entry = hashMap.constBegin();
-        while (entry != hashMap.constEnd()) {
-            int i = entry.key();
+        auto entry = entries.cbegin();
+        while (entry != entries.cend()) {
+            int i = entry->first;
             hTable[i] = quint16(upto >> 1);
 
             do {
-                const char *con = entry.value().constData();
-                uint len = uint(entry.value().length());
+                const QByteArray &con = contexts.at(entry->second);
+                uint len = uint(con.length());
                 len = qMin(len, 255u);
-                t << quint8(len);
-                t.writeRawData(con, len);
+                contextPool.append(char(len));
+                contextPool.append(con.constData(), len);
                 upto += 1 + len;
                 ++entry;
-            } while (entry != hashMap.constEnd() && entry.key() == i);
+            } while (entry != entries.cend() && entry->first == i);
             if (upto & 0x1) {
                 // offsets have to be even
-                t << quint8(0); // empty string
+                contextPool.append(char(0)); // empty string
                 ++upto;
             }
         }
-        t.device()->seek(2);
-        for (int j = 0; j < hTableSize; j++)
-            t << hTable[j];
-        delete [] hTable;
 
         if (upto > 131072) {
             qWarning("Releaser::squeeze: Too many contexts");
-            m_contextArray.clear();
+        } else {
+            m_contextArray.reserve(2 + (hTableSize << 1) + contextPool.size());
+            appendQuint16(m_contextArray, hTableSize);
+            for (quint16 offset : qAsConst(hTable))
+                appendQuint16(m_contextArray, offset);
+            m_contextArray.append(contextPool);
         }
     }
 }
@@ -392,17 +492,17 @@ void Releaser::insert(const TranslatorMessage &message, const QStringList &tlns,
         ByteTranslatorMessage bmsg2(
                 bmsg.context(), bmsg.sourceText(), QByteArray(""), bmsg.translations());
         if (!m_messages.contains(bmsg2)) {
-            m_messages.insert(bmsg2, 0);
+            m_messages.insert(bmsg2);
             return;
         }
     }
-    m_messages.insert(bmsg, 0);
+    m_messages.insert(bmsg);
 }
 
 void Releaser::insertIdBased(const TranslatorMessage &message, const QStringList &tlns)
 {
     ByteTranslatorMessage bmsg("", originalBytes(message.id()), "", tlns);
-    m_messages.insert(bmsg, 0);
+    m_messages.insert(bmsg);
 }
 
 void Releaser::setNumerusRules(const QByteArray &rules)
@@ -434,9 +534,9 @@ static void fromBytes(const char *str, int len, QString *out, bool *utf8Fail)
 
 bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
 {
-    QByteArray ba = dev.readAll();
-    const uchar *data = (uchar*)ba.data();
-    int len = ba.size();
+    const DeviceData input(dev);
+    const uchar *data = reinterpret_cast<const uchar *>(input.data());
+    qsizetype len = input.size();
     if (len < MagicLength || memcmp(data, magic, MagicLength) != 0) {
         cd.appendError(QLatin1String("QM-Format error: magic marker missing"));
         return false;
@@ -507,6 +607,9 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
 
     QString context, sourcetext, comment;
     QStringList translations;
+    // Messages of one context repeat its name; decode it only once. The keys
+    // point into the input data.
+    QHash<QByteArray, QString> contexts;
 
     for (const uchar *start = offsetArray; start != offsetArray + (numItems << 3); start += 8) {
         //quint32 hash = read32(start);
@@ -531,12 +634,9 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
                     return false;
                 }
                 QString str;
-                if (len != -1)
-                    str = QString((const QChar *)m, len / 2);
-                if (QSysInfo::ByteOrder == QSysInfo::LittleEndian) {
-                    for (int i = 0; i < str.length(); ++i)
-                        str[i] = QChar((str.at(i).unicode() >> 8) +
-                            ((str.at(i).unicode() << 8) & 0xff00));
+                if (len != -1) {
+                    str = QString(len / 2, Qt::Uninitialized);
+                    qFromBigEndian<char16_t>(m, len / 2, str.data());
                 }
                 translations << str;
                 m += len;
@@ -560,7 +660,16 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
                 m += 4;
                 //qDebug() << "CONTEXT LEN: " << len;
                 //qDebug() << "CONTEXT: " << QByteArray((const char*)m, len);
-                fromBytes((const char*)m, len, &context, &utf8Fail);
+                const QByteArray raw = QByteArray::fromRawData((const char*)m, len);
+                const auto it = contexts.constFind(raw);
+                if (it != contexts.cend()) {
+                    context = *it;
+                    utf8Fail = false; // as decoding it again would
+                } else {
+                    fromBytes((const char*)m, len, &context, &utf8Fail);
+                    if (!utf8Fail)
+                        contexts.insert(raw, context);
+                }
                 m += len;
                 break;
             }
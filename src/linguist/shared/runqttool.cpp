@@ -3,10 +3,9 @@
 
 #include "runqttool.h"
 
-#include "profileutils.h"
-
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qprocess.h>
 #include <QtCore/qregularexpression.h>
 
 #include <cstdlib>
@@ -80,20 +79,30 @@ void runQtTool(const QString &toolName, const QStringList &arguments,
         exit(exitCode);
 }
 
-void runInternalQtTool(const QString &toolName, const QStringList &arguments)
+void runQtTool(const QString &toolName, const QStringList &arguments, const QByteArray &input,
+               QLibraryInfo::LibraryPath location)
 {
-    runQtTool(toolName, arguments, QLibraryInfo::LibraryExecutablesPath);
+    // The tool shares our output channels and reads the input from its standard input
+    const QString program = qtToolFilePath(toolName, location);
+    QProcess process;
+    process.setProcessChannelMode(QProcess::ForwardedChannels);
+    process.start(program, arguments);
+    if (!process.waitForStarted(-1)) {
+        printErr(FMT::tr("Cannot run %1: %2\n").arg(program, process.errorString()));
+        exit(1);
+    }
+    process.write(input);
+    process.closeWriteChannel();
+    process.waitForFinished(-1);
+    if (process.exitStatus() != QProcess::NormalExit) {
+        printErr(FMT::tr("%1 crashed.\n").arg(program));
+        exit(1);
+    }
+    if (process.exitCode() != 0)
+        exit(process.exitCode());
 }
 
-std::unique_ptr<QTemporaryFile> createProjectDescription(QStringList args)
+void runInternalQtTool(const QString &toolName, const QStringList &arguments)
 {
-    std::unique_ptr<QTemporaryFile> file(new QTemporaryFile(QStringLiteral("XXXXXX.json")));
-    if (!file->open()) {
-        printErr(FMT::tr("Cannot create temporary file: %1\n").arg(file->errorString()));
-        exit(1);
-    }
-    file->close();
-    args << QStringLiteral("-out") << file->fileName();
-    runInternalQtTool(QStringLiteral("lprodump"), args);
-    return file;
+    runQtTool(toolName, arguments, QLibraryInfo::LibraryExecutablesPath);
 }
@@ -4,16 +4,15 @@
 #ifndef RUNQTTOOL_H
 #define RUNQTTOOL_H
 
+#include <QtCore/qbytearray.h>
 #include <QtCore/qlibraryinfo.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringlist.h>
-#include <QtCore/qtemporaryfile.h>
-
-#include <memory>
 
 void runQtTool(const QString &toolName, const QStringList &arguments,
                QLibraryInfo::LibraryPath location = QLibraryInfo::BinariesPath);
+void runQtTool(const QString &toolName, const QStringList &arguments, const QByteArray &input,
+               QLibraryInfo::LibraryPath location = QLibraryInfo::BinariesPath);
 void runInternalQtTool(const QString &toolName, const QStringList &arguments);
-std::unique_ptr<QTemporaryFile> createProjectDescription(QStringList args);
 
 #endif // RUNQTTOOL_H
@@ -7,6 +7,7 @@
 #include <QtCore/QByteArray>
 #include <QtCore/QString>
 #include <QtCore/QList>
+#include <QtCore/qalgorithms.h>
 
 
 QT_BEGIN_NAMESPACE
@@ -71,29 +72,6 @@ static const int indexOf[256] = {
     15, 12, 16, 17, 18, 19, 2,  10, 15, 7,  19, 2,  6,  7,  10, 0
 };
 
-/*
-  The entry bitCount[i] (for i between 0 and 255) is the number of bits used to
-  represent i in binary.
-*/
-static const int bitCount[256] = {
-    0,  1,  1,  2,  1,  2,  2,  3,  1,  2,  2,  3,  2,  3,  3,  4,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    4,  5,  5,  6,  5,  6,  6,  7,  5,  6,  6,  7,  6,  7,  7,  8
-};
-
 static inline void setCoOccurence(CoMatrix &m, char c, char d)
 {
     int k = indexOf[(uchar) c] + 20 * indexOf[(uchar) d];
@@ -119,80 +97,139 @@ CoMatrix::CoMatrix(const QString &str)
     }
 }
 
+/*
+  Only the first 400 bits are ever set, so counting all 13 words is the same
+  as counting the 50 bytes of the matrix; qPopulationCount() maps to the
+  hardware instruction where available.
+*/
 static inline int worth(const CoMatrix &m)
 {
     int w = 0;
-    for (int i = 0; i < 50; i++)
-        w += bitCount[m.b[i]];
+    for (int i = 0; i < 13; ++i)
+        w += qPopulationCount(m.w[i]);
     return w;
 }
 
-static inline CoMatrix reunion(const CoMatrix &m, const CoMatrix &n)
+static inline int worthOfIntersection(const CoMatrix &m, const CoMatrix &n)
 {
-    CoMatrix p;
+    int w = 0;
     for (int i = 0; i < 13; ++i)
-        p.w[i] = m.w[i] | n.w[i];
-    return p;
+        w += qPopulationCount(m.w[i] & n.w[i]);
+    return w;
 }
 
-static inline CoMatrix intersection(const CoMatrix &m, const CoMatrix &n)
+static inline int worthOfReunion(const CoMatrix &m, const CoMatrix &n)
 {
-    CoMatrix p;
+    int w = 0;
     for (int i = 0; i < 13; ++i)
-        p.w[i] = m.w[i] & n.w[i];
-    return p;
+        w += qPopulationCount(m.w[i] | n.w[i]);
+    return w;
+}
+
+static inline int similarityScore(int intersection, int reunion, int delta)
+{
+    return ((intersection + 1) << 10) / (reunion + (delta << 1) + 1);
+}
+
+qsizetype SimilarTextIndex::append(const QString &text)
+{
+    Entry entry{ CoMatrix(text), int(text.length()), 0 };
+    entry.worth = worth(entry.cm);
+    m_entries.append(entry);
+    return m_entries.size() - 1;
 }
 
 StringSimilarityMatcher::StringSimilarityMatcher(const QString &stringToMatch)
     : m_cm(stringToMatch)
 {
     m_length = stringToMatch.length();
+    m_worth = worth(m_cm);
 }
 
 int StringSimilarityMatcher::getSimilarityScore(const QString &strCandidate)
 {
     CoMatrix cmTarget(strCandidate);
     int delta = qAbs(m_length - strCandidate.size());
-    int score = ( (worth(intersection(m_cm, cmTarget)) + 1) << 10 ) /
-        ( worth(reunion(m_cm, cmTarget)) + (delta << 1) + 1 );
-    return score;
+    return similarityScore(worthOfIntersection(m_cm, cmTarget),
+                           worthOfReunion(m_cm, cmTarget), delta);
+}
+
+int StringSimilarityMatcher::getSimilarityScore(const SimilarTextIndex &index, qsizetype i) const
+{
+    const SimilarTextIndex::Entry &entry = index.m_entries.at(i);
+    int delta = qAbs(m_length - entry.length);
+    return similarityScore(worthOfIntersection(m_cm, entry.cm),
+                           worthOfReunion(m_cm, entry.cm), delta);
+}
+
+int StringSimilarityMatcher::maxSimilarityScore(const SimilarTextIndex &index, qsizetype i) const
+{
+    // The intersection cannot have more bits than the smaller matrix,
+    // and the reunion cannot have fewer bits than the larger one.
+    const SimilarTextIndex::Entry &entry = index.m_entries.at(i);
+    int delta = qAbs(m_length - entry.length);
+    return similarityScore(qMin(m_worth, entry.worth), qMax(m_worth, entry.worth), delta);
+}
+
+void buildSimilarTextIndex(const Translator *tor, SimilarTextIndex *index)
+{
+    index->clear();
+    index->reserve(tor->messageCount());
+    for (const TranslatorMessage &mtm : tor->messages())
+        index->append(mtm.sourceText());
 }
 
 CandidateList similarTextHeuristicCandidates(const Translator *tor,
     const QString &text, int maxCandidates)
+{
+    SimilarTextIndex index;
+    buildSimilarTextIndex(tor, &index);
+    return similarTextHeuristicCandidates(tor, index, text, maxCandidates);
+}
+
+CandidateList similarTextHeuristicCandidates(const Translator *tor,
+    const SimilarTextIndex &index, const QString &text, int maxCandidates)
 {
     QList<int> scores;
     CandidateList candidates;
     StringSimilarityMatcher matcher(text);
 
-    for (const TranslatorMessage &mtm : tor->messages()) {
+    for (int mi = 0; mi < index.size(); ++mi) {
+        // A full list only accepts strictly better scores.
+        const int minScore = candidates.size() == maxCandidates
+                ? scores[maxCandidates - 1] + 1 : textSimilarityThreshold;
+        if (matcher.maxSimilarityScore(index, mi) < minScore)
+            continue;
+
+        int score = matcher.getSimilarityScore(index, mi);
+        if (score < minScore)
+            continue;
+
+        const TranslatorMessage &mtm = tor->constMessage(mi);
         if (mtm.type() == TranslatorMessage::Unfinished
             || mtm.translation().isEmpty())
             continue;
 
-        QString s = mtm.sourceText();
-        int score = matcher.getSimilarityScore(s);
-
-        if (candidates.size() == maxCandidates && score > scores[maxCandidates - 1] )
+        if (candidates.size() == maxCandidates) {
             candidates.removeLast();
+            scores.removeLast();
+        }
+
+        Candidate cand(mtm.context(), mtm.sourceText(), mtm.comment(), mtm.translation());
 
-        if (candidates.size() < maxCandidates && score >= textSimilarityThreshold) {
-            Candidate cand(mtm.context(), s, mtm.comment(), mtm.translation());
-
-            int i;
-            for (i = 0; i < candidates.size(); i++) {
-                if (score >= scores.at(i)) {
-                    if (score == scores.at(i)) {
-                        if (candidates.at(i) == cand)
-                            goto continue_outer_loop;
-                    } else {
-                        break;
-                    }
+        int i;
+        for (i = 0; i < candidates.size(); i++) {
+            if (score >= scores.at(i)) {
+                if (score == scores.at(i)) {
+                    if (candidates.at(i) == cand)
+                        goto continue_outer_loop;
+                } else {
+                    break;
                 }
             }
-            scores.insert(i, score);
-            candidates.insert(i, cand);
         }
+        scores.insert(i, score);
+        candidates.insert(i, cand);
         continue_outer_loop:
         ;
     }
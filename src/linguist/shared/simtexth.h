@@ -51,6 +51,32 @@ struct CoMatrix
     };
 };
 
+/**
+ * Holds the precomputed CoMatrix of a list of candidate strings in one
+ * contiguous array, so that searching the same candidates repeatedly does
+ * not have to convert and scan every candidate string again.
+ * Entries are addressed by the position at which they were appended.
+ * \sa StringSimilarityMatcher
+ */
+class SimilarTextIndex {
+public:
+    void clear() { m_entries.clear(); }
+    void reserve(qsizetype size) { m_entries.reserve(size); }
+    qsizetype size() const { return m_entries.size(); }
+    qsizetype append(const QString &text);
+
+private:
+    friend class StringSimilarityMatcher;
+
+    struct Entry
+    {
+        CoMatrix cm;
+        int length;
+        int worth;
+    };
+    QList<Entry> m_entries;
+};
+
 /**
  * This class is more efficient for searching through a large array of candidate strings, since we only
  * have to construct the CoMatrix for the \a stringToMatch once,
@@ -61,10 +87,18 @@ class StringSimilarityMatcher {
 public:
     StringSimilarityMatcher(const QString &stringToMatch);
     int getSimilarityScore(const QString &strCandidate);
+    int getSimilarityScore(const SimilarTextIndex &index, qsizetype i) const;
+    /**
+     * Returns an upper bound of getSimilarityScore(index, i) that depends
+     * only on the lengths and co-occurrence counts of both strings, so that
+     * hopeless candidates can be skipped cheaply.
+     */
+    int maxSimilarityScore(const SimilarTextIndex &index, qsizetype i) const;
 
 private:
     CoMatrix m_cm;
     int m_length;
+    int m_worth;
 };
 
 /**
@@ -83,6 +117,17 @@ CandidateList similarTextHeuristicCandidates( const Translator *tor,
                                               const QString &text,
                                               int maxCandidates );
 
+/**
+ * Same as above, but uses \a index, which must hold the source texts of
+ * all messages of \a tor in order, instead of recomputing them.
+ */
+CandidateList similarTextHeuristicCandidates( const Translator *tor,
+                                              const SimilarTextIndex &index,
+                                              const QString &text,
+                                              int maxCandidates );
+
+void buildSimilarTextIndex(const Translator *tor, SimilarTextIndex *index);
+
 QT_END_NAMESPACE
 
 #endif
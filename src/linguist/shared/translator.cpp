@@ -6,6 +6,7 @@
 #include "simtexth.h"
 
 #include <iostream>
+#include <vector>
 
 #include <stdio.h>
 #ifdef Q_OS_WIN
@@ -20,6 +21,7 @@
 #include <QtCore/QFileInfo>
 #include <QtCore/QLocale>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QSaveFile>
 #include <QtCore/QTextStream>
 
 #include <private/qtranslator_p.h>
@@ -28,7 +30,8 @@ QT_BEGIN_NAMESPACE
 
 Translator::Translator() :
     m_locationsType(AbsoluteLocations),
-    m_indexOk(true)
+    m_indexOk(true),
+    m_refIndexOk(true)
 {
 }
 
@@ -85,6 +88,25 @@ void Translator::ensureIndexed() const
     }
 }
 
+/*
+  Maps (context, comment, file, line) to the first message having that
+  reference, for the reference based find() used by the similar-text
+  heuristic of lupdate.
+*/
+void Translator::ensureRefIndexed() const
+{
+    if (!m_refIndexOk) {
+        m_refIndexOk = true;
+        m_refIdx.clear();
+        // Walk backwards so that earlier messages win.
+        for (int i = m_messages.count() - 1; i >= 0; --i) {
+            const TranslatorMessage &msg = m_messages.at(i);
+            for (const auto &ref : msg.allReferences())
+                m_refIdx.insert(TMMRefKey(msg.context(), msg.comment(), ref), i);
+        }
+    }
+}
+
 void Translator::replaceSorted(const TranslatorMessage &msg)
 {
     int index = find(msg);
@@ -94,6 +116,7 @@ void Translator::replaceSorted(const TranslatorMessage &msg)
         delIndex(index);
         m_messages[index] = msg;
         addIndex(index, msg);
+        m_refIndexOk = false;
     }
 }
 
@@ -136,6 +159,7 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
             return;
         }
         emsg.addReferenceUniq(msg.fileName(), msg.lineNumber());
+        m_refIndexOk = false;
         if (!msg.extraComment().isEmpty()) {
             QString cmt = emsg.extraComment();
             if (!cmt.isEmpty()) {
@@ -154,6 +178,18 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
 
 void Translator::insert(int idx, const TranslatorMessage &msg)
 {
+    if (m_refIndexOk) {
+        if (idx == m_messages.count()) {
+            // Earlier messages win, so only references not seen yet are added.
+            for (const auto &ref : msg.allReferences()) {
+                const TMMRefKey key(msg.context(), msg.comment(), ref);
+                if (!m_refIdx.contains(key))
+                    m_refIdx.insert(key, idx);
+            }
+        } else {
+            m_refIndexOk = false;
+        }
+    }
     if (m_indexOk) {
         if (idx == m_messages.count())
             addIndex(idx, msg);
@@ -170,61 +206,171 @@ void Translator::append(const TranslatorMessage &msg)
 
 void Translator::appendSorted(const TranslatorMessage &msg)
 {
-    int msgLine = msg.lineNumber();
-    if (msgLine < 0) {
+    if (msg.lineNumber() < 0)
         append(msg);
-        return;
+    else
+        appendSorted(QList<TranslatorMessage>{ msg });
+}
+
+/*
+  Inserts the messages one after the other next to the messages from the
+  same context and file, in line number order. The best insertion point lies
+  within the longest line-ordered run of such messages.
+
+  Messages of other contexts or files only terminate runs, so only the
+  messages with the same context and file are walked. Instead of moving the
+  following messages and their positions in the indexes for every message,
+  the new messages are linked into a list, and the messages and the indexes
+  are rebuilt once at the end.
+*/
+void Translator::appendSorted(const QList<TranslatorMessage> &msgs)
+{
+    const int oldCount = m_messages.count();
+    const int count = oldCount + msgs.count();
+    const auto messageAt = [&](int i) -> const TranslatorMessage & {
+        return i < oldCount ? m_messages.at(i) : msgs.at(i - oldCount);
+    };
+
+    // All messages in order, and the messages of each (context, file) in order.
+    // The new messages follow the old ones; -1 is the end of a list.
+    std::vector<int> next(count, -1);
+    std::vector<int> prev(count, -1);
+    std::vector<int> groupNext(count, -1);
+    std::vector<int> groupPrev(count, -1);
+    struct Group
+    {
+        int first = -1;
+        int last = -1;
+    };
+    QHash<TMMSortKey, int> groupIds;
+    std::vector<Group> groups;
+    std::vector<int> groupOf(msgs.count());
+    for (int i = 0; i < msgs.count(); ++i) {
+        const TranslatorMessage &msg = msgs.at(i);
+        const auto it = groupIds.constFind(TMMSortKey(msg.context(), msg.fileName()));
+        if (it != groupIds.cend()) {
+            groupOf[i] = *it;
+        } else {
+            groupOf[i] = int(groups.size());
+            groupIds.insert(TMMSortKey(msg.context(), msg.fileName()), groupOf[i]);
+            groups.emplace_back();
+        }
+    }
+    for (int i = 0; i < oldCount; ++i) {
+        if (i)
+            prev[i] = i - 1;
+        if (i + 1 < oldCount)
+            next[i] = i + 1;
+        const TranslatorMessage &msg = m_messages.at(i);
+        const auto it = groupIds.constFind(TMMSortKey(msg.context(), msg.fileName()));
+        if (it == groupIds.cend())
+            continue;
+        Group &group = groups[*it];
+        groupPrev[i] = group.last;
+        if (group.last >= 0)
+            groupNext[group.last] = i;
+        else
+            group.first = i;
+        group.last = i;
     }
+    int first = oldCount ? 0 : -1;
+    int last = oldCount - 1;
 
-    int bestIdx = 0; // Best insertion point found so far
-    int bestScore = 0; // Its category: 0 = no hit, 1 = pre or post, 2 = middle
-    int bestSize = 0; // The length of the region. Longer is better within one category.
-
-    // The insertion point to use should this region turn out to be the best one so far
-    int thisIdx = 0;
-    int thisScore = 0;
-    int thisSize = 0;
-    // Working vars
-    int prevLine = 0;
-    int curIdx = 0;
-    for (const TranslatorMessage &mit : qAsConst(m_messages)) {
-        bool sameFile = mit.fileName() == msg.fileName() && mit.context() == msg.context();
-        int curLine;
-        if (sameFile && (curLine = mit.lineNumber()) >= prevLine) {
-            if (msgLine >= prevLine && msgLine < curLine) {
-                thisIdx = curIdx;
-                thisScore = thisSize ? 2 : 1;
+    // Where a message goes: before a message (or at the end, if -1), and after
+    // a message of its group (or at the start of the group, if -1).
+    struct Position
+    {
+        int before;
+        int groupAfter;
+    };
+    bool inMiddle = false;
+    for (int i = 0; i < msgs.count(); ++i) {
+        const TranslatorMessage &msg = msgs.at(i);
+        const int msgLine = msg.lineNumber();
+        Group &group = groups[groupOf[i]];
+
+        Position bestPos = { -1, group.last }; // Best insertion point found so far
+        int bestScore = 0; // Its category: 0 = no hit, 1 = pre or post, 2 = middle
+        int bestSize = 0; // The length of the region. Longer is better within one category.
+
+        // The insertion point to use should this region turn out to be the best one so far
+        Position thisPos = { -1, -1 };
+        int thisScore = 0;
+        int thisSize = 0;
+        // Working vars
+        int prevLine = 0;
+        const auto endRegion = [&](Position pos, bool sameFile) {
+            if (!thisScore) {
+                thisPos = pos;
+                thisScore = 1;
             }
-            ++thisSize;
-            prevLine = curLine;
-        } else {
-            if (thisSize) {
-                if (!thisScore) {
-                    thisIdx = curIdx;
-                    thisScore = 1;
-                }
-                if (thisScore > bestScore || (thisScore == bestScore && thisSize > bestSize)) {
-                    bestIdx = thisIdx;
-                    bestScore = thisScore;
-                    bestSize = thisSize;
+            if (thisScore > bestScore || (thisScore == bestScore && thisSize > bestSize)) {
+                bestPos = thisPos;
+                bestScore = thisScore;
+                bestSize = thisSize;
+            }
+            thisScore = 0;
+            thisSize = sameFile ? 1 : 0;
+            prevLine = 0;
+        };
+
+        if (msgLine >= 0) {
+            int lastIdx = -1;
+            for (int curIdx = group.first; curIdx >= 0; curIdx = groupNext[curIdx]) {
+                // A message from elsewhere in between ends the region.
+                if (thisSize && next[lastIdx] != curIdx)
+                    endRegion({ next[lastIdx], lastIdx }, false);
+                int curLine = messageAt(curIdx).lineNumber();
+                if (curLine >= prevLine) {
+                    if (msgLine >= prevLine && msgLine < curLine) {
+                        thisPos = { curIdx, groupPrev[curIdx] };
+                        thisScore = thisSize ? 2 : 1;
+                    }
+                    ++thisSize;
+                    prevLine = curLine;
+                } else if (thisSize) {
+                    endRegion({ curIdx, groupPrev[curIdx] }, true);
                 }
-                thisScore = 0;
-                thisSize = sameFile ? 1 : 0;
-                prevLine = 0;
+                lastIdx = curIdx;
             }
+            if (thisSize)
+                endRegion({ next[lastIdx], lastIdx }, false);
         }
-        ++curIdx;
+
+        const int idx = oldCount + i;
+        const int after = bestPos.before >= 0 ? prev[bestPos.before] : last;
+        next[idx] = bestPos.before;
+        prev[idx] = after;
+        (after >= 0 ? next[after] : first) = idx;
+        (bestPos.before >= 0 ? prev[bestPos.before] : last) = idx;
+        if (bestPos.before >= 0)
+            inMiddle = true;
+
+        const int groupBefore = bestPos.groupAfter >= 0 ? groupNext[bestPos.groupAfter]
+                                                        : group.first;
+        groupPrev[idx] = bestPos.groupAfter;
+        groupNext[idx] = groupBefore;
+        (bestPos.groupAfter >= 0 ? groupNext[bestPos.groupAfter] : group.first) = idx;
+        (groupBefore >= 0 ? groupPrev[groupBefore] : group.last) = idx;
+    }
+
+    if (!inMiddle) {
+        for (const TranslatorMessage &msg : msgs)
+            append(msg);
+        return;
     }
-    if (thisSize && !thisScore) {
-        thisIdx = curIdx;
-        thisScore = 1;
+
+    TMM messages;
+    messages.reserve(count);
+    for (int i = first; i >= 0; i = next[i]) {
+        if (i < oldCount)
+            messages.append(std::move(m_messages[i]));
+        else
+            messages.append(msgs.at(i - oldCount));
     }
-    if (thisScore > bestScore || (thisScore == bestScore && thisSize > bestSize))
-        insert(thisIdx, msg);
-    else if (bestScore)
-        insert(bestIdx, msg);
-    else
-        append(msg);
+    m_messages = std::move(messages);
+    m_indexOk = false;
+    m_refIndexOk = false;
 }
 
 static QString guessFormat(const QString &filename, const QString &format)
@@ -242,12 +388,11 @@ static QString guessFormat(const QString &filename, const QString &format)
     return QLatin1String("ts");
 }
 
-bool Translator::load(const QString &filename, ConversionData &cd, const QString &format)
+static bool openInputFile(QFile &file, const QString &filename, ConversionData &cd)
 {
     cd.m_sourceDir = QFileInfo(filename).absoluteDir();
     cd.m_sourceFileName = filename;
 
-    QFile file;
     if (filename.isEmpty() || filename == QLatin1String("-")) {
 #ifdef Q_OS_WIN
         // QFile is broken for text files
@@ -266,6 +411,62 @@ bool Translator::load(const QString &filename, ConversionData &cd, const QString
             return false;
         }
     }
+    return true;
+}
+
+static bool openOutputFile(QFile &file, const QString &filename, ConversionData &cd)
+{
+    if (filename.isEmpty() || filename == QLatin1String("-")) {
+#ifdef Q_OS_WIN
+        // QFile is broken for text files
+        ::_setmode(1, _O_BINARY);
+#endif
+        if (!file.open(stdout, QIODevice::WriteOnly)) {
+            cd.appendError(QString::fromLatin1("Cannot open stdout!? (%1)")
+                .arg(file.errorString()));
+            return false;
+        }
+    } else {
+        file.setFileName(filename);
+        if (!file.open(QIODevice::WriteOnly)) {
+            cd.appendError(QString::fromLatin1("Cannot create %1: %2")
+                .arg(filename, file.errorString()));
+            return false;
+        }
+    }
+    return true;
+}
+
+DeviceData::DeviceData(QIODevice &dev)
+{
+    QFile *file = qobject_cast<QFile *>(&dev);
+    if (file && !file->isSequential()) {
+        const qint64 pos = file->pos();
+        const qint64 size = file->size() - pos;
+        if (size > 0 && (m_map = file->map(pos, size))) {
+            m_file = file;
+            m_data = reinterpret_cast<const char *>(m_map);
+            m_size = size;
+            file->seek(pos + size);
+            return;
+        }
+    }
+    m_buffer = dev.readAll();
+    m_data = m_buffer.constData();
+    m_size = m_buffer.size();
+}
+
+DeviceData::~DeviceData()
+{
+    if (m_map)
+        m_file->unmap(m_map);
+}
+
+bool Translator::load(const QString &filename, ConversionData &cd, const QString &format)
+{
+    QFile file;
+    if (!openInputFile(file, filename, cd))
+        return false;
 
     QString fmt = guessFormat(filename, format);
 
@@ -288,24 +489,8 @@ bool Translator::load(const QString &filename, ConversionData &cd, const QString
 bool Translator::save(const QString &filename, ConversionData &cd, const QString &format) const
 {
     QFile file;
-    if (filename.isEmpty() || filename == QLatin1String("-")) {
-#ifdef Q_OS_WIN
-        // QFile is broken for text files
-        ::_setmode(1, _O_BINARY);
-#endif
-        if (!file.open(stdout, QIODevice::WriteOnly)) {
-            cd.appendError(QString::fromLatin1("Cannot open stdout!? (%1)")
-                .arg(file.errorString()));
-            return false;
-        }
-    } else {
-        file.setFileName(filename);
-        if (!file.open(QIODevice::WriteOnly)) {
-            cd.appendError(QString::fromLatin1("Cannot create %1: %2")
-                .arg(filename, file.errorString()));
-            return false;
-        }
-    }
+    if (!openOutputFile(file, filename, cd))
+        return false;
 
     QString fmt = guessFormat(filename, format);
     cd.m_targetDir = QFileInfo(filename).absoluteDir();
@@ -324,6 +509,48 @@ bool Translator::save(const QString &filename, ConversionData &cd, const QString
     return false;
 }
 
+bool Translator::stream(const QString &inFileName, const QString &inFormat,
+                        const QString &outFileName, const QString &outFormat,
+                        ConversionData &cd, LocationsType locationsType,
+                        const HeaderHandler &headerHandler, const MessageFilter &filter)
+{
+    if (guessFormat(inFileName, inFormat) != QLatin1String("ts")
+        || guessFormat(outFileName, outFormat) != QLatin1String("ts")) {
+        cd.appendError(QLatin1String("Only TS files can be converted in streaming mode"));
+        return false;
+    }
+
+    QFile in;
+    if (!openInputFile(in, inFileName, cd))
+        return false;
+    cd.m_targetDir = QFileInfo(outFileName).absoluteDir();
+
+    if (outFileName.isEmpty() || outFileName == QLatin1String("-")) {
+        QFile out;
+        if (!openOutputFile(out, outFileName, cd))
+            return false;
+        return streamTS(in, out, cd, locationsType, headerHandler, filter);
+    }
+
+    // The output replaces the file only once all of the input was read, so
+    // the input can be converted in place, and nothing is left behind on
+    // errors.
+    QSaveFile out(outFileName);
+    if (!out.open(QIODevice::WriteOnly)) {
+        cd.appendError(QString::fromLatin1("Cannot create %1: %2")
+            .arg(outFileName, out.errorString()));
+        return false;
+    }
+    if (!streamTS(in, out, cd, locationsType, headerHandler, filter))
+        return false;
+    if (!out.commit()) {
+        cd.appendError(QString::fromLatin1("Cannot save %1: %2")
+            .arg(outFileName, out.errorString()));
+        return false;
+    }
+    return true;
+}
+
 QString Translator::makeLanguageCode(QLocale::Language language, QLocale::Country country)
 {
     QString result = QLocale::languageToCode(language);
@@ -370,19 +597,16 @@ int Translator::find(const TranslatorMessage &msg) const
 int Translator::find(const QString &context,
     const QString &comment, const TranslatorMessage::References &refs) const
 {
+    int found = -1;
     if (!refs.isEmpty()) {
-        for (auto it = m_messages.cbegin(), end = m_messages.cend(); it != end; ++it) {
-            if (it->context() == context && it->comment() == comment) {
-                for (const auto &itref : it->allReferences()) {
-                    for (const auto &ref : refs) {
-                        if (itref == ref)
-                            return it - m_messages.cbegin();
-                    }
-                }
-            }
+        ensureRefIndexed();
+        for (const auto &ref : refs) {
+            int i = m_refIdx.value(TMMRefKey(context, comment, ref), -1);
+            if (i >= 0 && (found < 0 || i < found))
+                found = i;
         }
     }
-    return -1;
+    return found;
 }
 
 int Translator::find(const QString &context) const
@@ -399,6 +623,7 @@ void Translator::stripObsoleteMessages()
         else
             ++it;
     m_indexOk = false;
+    m_refIndexOk = false;
 }
 
 void Translator::stripFinishedMessages()
@@ -409,6 +634,7 @@ void Translator::stripFinishedMessages()
         else
             ++it;
     m_indexOk = false;
+    m_refIndexOk = false;
 }
 
 void Translator::stripUntranslatedMessages()
@@ -419,6 +645,7 @@ void Translator::stripUntranslatedMessages()
         else
             ++it;
     m_indexOk = false;
+    m_refIndexOk = false;
 }
 
 bool Translator::translationsExist() const
@@ -438,6 +665,7 @@ void Translator::stripEmptyContexts()
         else
             ++it;
     m_indexOk = false;
+    m_refIndexOk = false;
 }
 
 void Translator::stripNonPluralForms()
@@ -448,6 +676,7 @@ void Translator::stripNonPluralForms()
         else
             ++it;
     m_indexOk = false;
+    m_refIndexOk = false;
 }
 
 void Translator::stripIdenticalSourceTranslations()
@@ -460,6 +689,7 @@ void Translator::stripIdenticalSourceTranslations()
             ++it;
     }
     m_indexOk = false;
+    m_refIndexOk = false;
 }
 
 void Translator::dropTranslations()
@@ -471,24 +701,29 @@ void Translator::dropTranslations()
     }
 }
 
-void Translator::dropUiLines()
+void Translator::dropUiLines(TranslatorMessage &message)
 {
     const QString uiXt = QLatin1String(".ui");
     const QString juiXt = QLatin1String(".jui");
-    for (auto &message : m_messages) {
-        QHash<QString, int> have;
-        QList<TranslatorMessage::Reference> refs;
-        for (const auto &itref : message.allReferences()) {
-            const QString &fn = itref.fileName();
-            if (fn.endsWith(uiXt) || fn.endsWith(juiXt)) {
-                if (++have[fn] == 1)
-                    refs.append(TranslatorMessage::Reference(fn, -1));
-            } else {
-                refs.append(itref);
-            }
+    QHash<QString, int> have;
+    QList<TranslatorMessage::Reference> refs;
+    for (const auto &itref : message.allReferences()) {
+        const QString &fn = itref.fileName();
+        if (fn.endsWith(uiXt) || fn.endsWith(juiXt)) {
+            if (++have[fn] == 1)
+                refs.append(TranslatorMessage::Reference(fn, -1));
+        } else {
+            refs.append(itref);
         }
-        message.setReferences(refs);
     }
+    message.setReferences(refs);
+}
+
+void Translator::dropUiLines()
+{
+    for (auto &message : m_messages)
+        dropUiLines(message);
+    m_refIndexOk = false;
 }
 
 struct TranslatorMessageIdPtr {
@@ -597,6 +832,7 @@ Translator::Duplicates Translator::resolveDuplicates()
         if (!omsg->isTranslated() && msg.isTranslated())
             omsg->setTranslations(msg.translations());
         m_indexOk = false;
+        m_refIndexOk = false;
         // don't remove the duplicate entries yet to not mess up the pointers that
         // are in the hashes
         duplicateIndices.append(i);
@@ -609,23 +845,29 @@ Translator::Duplicates Translator::resolveDuplicates()
 
 void Translator::reportDuplicates(const Duplicates &dupes,
                                   const QString &fileName, bool verbose)
+{
+    reportDuplicates(dupes, fileName, verbose, std::cerr);
+}
+
+void Translator::reportDuplicates(const Duplicates &dupes,
+                                  const QString &fileName, bool verbose, std::ostream &out)
 {
     if (!dupes.byId.isEmpty() || !dupes.byContents.isEmpty()) {
-        std::cerr << "Warning: dropping duplicate messages in '" << qPrintable(fileName);
+        out << "Warning: dropping duplicate messages in '" << qPrintable(fileName);
         if (!verbose) {
-            std::cerr << "'\n(try -verbose for more info).\n";
+            out << "'\n(try -verbose for more info).\n";
         } else {
-            std::cerr << "':\n";
+            out << "':\n";
             for (int i : dupes.byId)
-                std::cerr << "\n* ID: " << qPrintable(message(i).id()) << std::endl;
+                out << "\n* ID: " << qPrintable(message(i).id()) << std::endl;
             for (int j : dupes.byContents) {
                 const TranslatorMessage &msg = message(j);
-                std::cerr << "\n* Context: " << qPrintable(msg.context())
-                          << "\n* Source: " << qPrintable(msg.sourceText()) << std::endl;
+                out << "\n* Context: " << qPrintable(msg.context())
+                    << "\n* Source: " << qPrintable(msg.sourceText()) << std::endl;
                 if (!msg.comment().isEmpty())
-                    std::cerr << "* Comment: " << qPrintable(msg.comment()) << std::endl;
+                    out << "* Comment: " << qPrintable(msg.comment()) << std::endl;
             }
-            std::cerr << std::endl;
+            out << std::endl;
         }
     }
 }
@@ -644,6 +886,7 @@ void Translator::makeFileNamesAbsolute(const QDir &originalPath)
             msg.addReference(fileName, ref.lineNumber());
         }
     }
+    m_refIndexOk = false;
 }
 
 const QList<TranslatorMessage> &Translator::messages() const
@@ -668,18 +911,24 @@ QStringList Translator::normalizedTranslations(const TranslatorMessage &msg, int
     return translations;
 }
 
-void Translator::normalizeTranslations(ConversionData &cd)
+int Translator::numerusFormCount(const QString &languageCode)
 {
-    bool truncated = false;
     QLocale::Language l;
     QLocale::Country c;
-    languageAndCountry(languageCode(), &l, &c);
+    languageAndCountry(languageCode, &l, &c);
     int numPlurals = 1;
     if (l != QLocale::C) {
         QStringList forms;
         if (getNumerusInfo(l, c, 0, &forms, 0))
             numPlurals = forms.count(); // includes singular
     }
+    return numPlurals;
+}
+
+void Translator::normalizeTranslations(ConversionData &cd)
+{
+    bool truncated = false;
+    const int numPlurals = numerusFormCount(languageCode());
     for (int i = 0; i < m_messages.count(); ++i) {
         const TranslatorMessage &msg = m_messages.at(i);
         QStringList tlns = msg.translations();
@@ -14,6 +14,8 @@
 #include <QString>
 #include <QSet>
 
+#include <functional>
+#include <iosfwd>
 
 QT_BEGIN_NAMESPACE
 
@@ -21,6 +23,7 @@ class FMT {
     Q_DECLARE_TR_FUNCTIONS(Linguist)
 };
 
+class QFile;
 class QIODevice;
 
 // A struct of "interesting" data passed to and from the load and save routines
@@ -33,7 +36,8 @@ public:
         m_sortContexts(false),
         m_noUiLines(false),
         m_idBased(false),
-        m_saveMode(SaveEverything)
+        m_saveMode(SaveEverything),
+        m_threadCount(0)
     {}
 
     // tag manipulation
@@ -56,6 +60,7 @@ public:
     QString m_sourceFileName;
     QString m_targetFileName;
     QString m_compilationDatabaseDir;
+    QString m_extractionCacheFile; // CPP specific
     QStringList m_excludes;
     QDir m_sourceDir;
     QDir m_targetDir; // FIXME: TS specific
@@ -71,6 +76,7 @@ public:
     bool m_idBased;
     TranslatorSaveMode m_saveMode;
     QStringList m_rootDirs;
+    int m_threadCount; // 0 for one per processor
 };
 
 class TMMKey {
@@ -87,6 +93,35 @@ inline size_t qHash(const TMMKey &key)
     return qHash(key.context) ^ qHash(key.source) ^ qHash(key.comment);
 }
 
+class TMMRefKey {
+public:
+    TMMRefKey(const QString &ctx, const QString &cmt, const TranslatorMessage::Reference &ref)
+        : context(ctx), comment(cmt), fileName(ref.fileName()), lineNumber(ref.lineNumber()) {}
+    bool operator==(const TMMRefKey &o) const
+        { return lineNumber == o.lineNumber && fileName == o.fileName
+                 && context == o.context && comment == o.comment; }
+    QString context, comment, fileName;
+    int lineNumber;
+};
+Q_DECLARE_TYPEINFO(TMMRefKey, Q_RELOCATABLE_TYPE);
+inline size_t qHash(const TMMRefKey &key)
+{
+    return qHash(key.context) ^ qHash(key.comment) ^ qHash(key.fileName) ^ qHash(key.lineNumber);
+}
+
+class TMMSortKey {
+public:
+    TMMSortKey(const QString &ctx, const QString &fn) : context(ctx), fileName(fn) {}
+    bool operator==(const TMMSortKey &o) const
+        { return fileName == o.fileName && context == o.context; }
+    QString context, fileName;
+};
+Q_DECLARE_TYPEINFO(TMMSortKey, Q_RELOCATABLE_TYPE);
+inline size_t qHash(const TMMSortKey &key)
+{
+    return qHash(key.context) ^ qHash(key.fileName);
+}
+
 class Translator
 {
 public:
@@ -105,6 +140,7 @@ public:
     void extend(const TranslatorMessage &msg, ConversionData &cd); // Only for single-location messages
     void append(const TranslatorMessage &msg);
     void appendSorted(const TranslatorMessage &msg);
+    void appendSorted(const QList<TranslatorMessage> &msgs);
 
     void stripObsoleteMessages();
     void stripFinishedMessages();
@@ -114,12 +150,15 @@ public:
     void stripIdenticalSourceTranslations();
     void dropTranslations();
     void dropUiLines();
+    static void dropUiLines(TranslatorMessage &msg);
     void makeFileNamesAbsolute(const QDir &originalPath);
     bool translationsExist() const;
 
     struct Duplicates { QSet<int> byId, byContents; };
     Duplicates resolveDuplicates();
     void reportDuplicates(const Duplicates &dupes, const QString &fileName, bool verbose);
+    void reportDuplicates(const Duplicates &dupes, const QString &fileName, bool verbose,
+                          std::ostream &out);
 
     QString languageCode() const { return m_language; }
     QString sourceLanguageCode() const { return m_sourceLanguage; }
@@ -128,6 +167,17 @@ public:
     void setLocationsType(LocationsType lt) { m_locationsType = lt; }
     LocationsType locationsType() const { return m_locationsType; }
 
+    // Streaming conversion, which never holds more than one message.
+    // The header handler sees the languages, dependencies and extras of the
+    // input before anything is written; the filter can modify each message,
+    // or drop it by returning false. Only TS files can be streamed.
+    typedef std::function<void(Translator &)> HeaderHandler;
+    typedef std::function<bool(TranslatorMessage &)> MessageFilter;
+    static bool stream(const QString &inFileName, const QString &inFormat,
+                       const QString &outFileName, const QString &outFormat,
+                       ConversionData &cd, LocationsType locationsType,
+                       const HeaderHandler &headerHandler, const MessageFilter &filter);
+
     static QString makeLanguageCode(QLocale::Language language, QLocale::Country country);
     static void languageAndCountry(QStringView languageCode,
         QLocale::Language *langPtr, QLocale::Country *countryPtr);
@@ -135,12 +185,13 @@ public:
     void setSourceLanguageCode(const QString &languageCode) { m_sourceLanguage = languageCode; }
     static QString guessLanguageCodeFromFileName(const QString &fileName);
     const QList<TranslatorMessage> &messages() const;
+    static int numerusFormCount(const QString &languageCode); // includes singular
     static QStringList normalizedTranslations(const TranslatorMessage &m, int numPlurals);
     void normalizeTranslations(ConversionData &cd);
     QStringList normalizedTranslations(const TranslatorMessage &m, ConversionData &cd, bool *ok) const;
 
     int messageCount() const { return m_messages.size(); }
-    TranslatorMessage &message(int i) { return m_messages[i]; }
+    TranslatorMessage &message(int i) { m_refIndexOk = false; return m_messages[i]; }
     const TranslatorMessage &message(int i) const { return m_messages.at(i); }
     const TranslatorMessage &constMessage(int i) const { return m_messages.at(i); }
     void dump() const;
@@ -185,6 +236,7 @@ private:
     void addIndex(int idx, const TranslatorMessage &msg) const;
     void delIndex(int idx) const;
     void ensureIndexed() const;
+    void ensureRefIndexed() const;
 
     typedef QList<TranslatorMessage> TMM;       // int stores the sequence position.
 
@@ -209,6 +261,10 @@ private:
     mutable QHash<QString, int> m_ctxCmtIdx;
     mutable QHash<QString, int> m_idMsgIdx;
     mutable QHash<TMMKey, int> m_msgIdx;
+    // References can be changed through message(), so this one is
+    // invalidated independently from the indexes above.
+    mutable bool m_refIndexOk;
+    mutable QHash<TMMRefKey, int> m_refIdx;
 };
 
 bool getNumerusInfo(QLocale::Language language, QLocale::Country country,
@@ -218,6 +274,34 @@ QString getNumerusInfoString();
 
 bool saveQM(const Translator &translator, QIODevice &dev, ConversionData &cd);
 
+/*
+  The rest of an input device's data, for loaders which parse it in place.
+  Regular files are memory-mapped; anything else (e.g. stdin) is read.
+  The data stays valid as long as this object and the device live.
+*/
+class DeviceData
+{
+public:
+    explicit DeviceData(QIODevice &dev);
+    ~DeviceData();
+
+    const char *data() const { return m_data; }
+    qsizetype size() const { return m_size; }
+
+private:
+    Q_DISABLE_COPY(DeviceData)
+
+    QFile *m_file = nullptr;
+    uchar *m_map = nullptr;
+    QByteArray m_buffer;
+    const char *m_data = nullptr;
+    qsizetype m_size = 0;
+};
+bool streamTS(QIODevice &in, QIODevice &out, ConversionData &cd,
+              Translator::LocationsType locationsType,
+              const Translator::HeaderHandler &headerHandler,
+              const Translator::MessageFilter &filter);
+
 /*
   This is a quick hack. The proper way to handle this would be
   to extend Translator's interface.
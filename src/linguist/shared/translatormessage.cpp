@@ -24,10 +24,10 @@ TranslatorMessage::TranslatorMessage(const QString &context,
     const QString &fileName, int lineNumber, const QStringList &translations,
     Type type, bool plural)
   : m_context(context), m_sourcetext(sourceText), m_comment(comment),
-    m_userData(userData),
     m_translations(translations), m_fileName(fileName), m_lineNumber(lineNumber),
     m_type(type), m_plural(plural)
 {
+    setUserData(userData);
 }
 
 void TranslatorMessage::addReference(const QString &fileName, int lineNumber)
@@ -36,7 +36,7 @@ void TranslatorMessage::addReference(const QString &fileName, int lineNumber)
         m_fileName = fileName;
         m_lineNumber = lineNumber;
     } else {
-        m_extraRefs.append(Reference(fileName, lineNumber));
+        rare().extraRefs.append(Reference(fileName, lineNumber));
     }
 }
 
@@ -48,13 +48,13 @@ void TranslatorMessage::addReferenceUniq(const QString &fileName, int lineNumber
     } else {
         if (fileName == m_fileName && lineNumber == m_lineNumber)
             return;
-        if (!m_extraRefs.isEmpty()) { // Rather common case, so special-case it
-            for (const Reference &ref : qAsConst(m_extraRefs)) {
+        if (m_rare.constData() && !m_rare.constData()->extraRefs.isEmpty()) { // Rather common case, so special-case it
+            for (const Reference &ref : m_rare.constData()->extraRefs) {
                 if (fileName == ref.fileName() && lineNumber == ref.lineNumber())
                     return;
             }
         }
-        m_extraRefs.append(Reference(fileName, lineNumber));
+        rare().extraRefs.append(Reference(fileName, lineNumber));
     }
 }
 
@@ -62,7 +62,8 @@ void TranslatorMessage::clearReferences()
 {
     m_fileName.clear();
     m_lineNumber = -1;
-    m_extraRefs.clear();
+    if (m_rare.constData() && !m_rare.constData()->extraRefs.isEmpty())
+        m_rare->extraRefs.clear();
 }
 
 void TranslatorMessage::setReferences(const TranslatorMessage::References &refs0)
@@ -72,7 +73,8 @@ void TranslatorMessage::setReferences(const TranslatorMessage::References &refs0
         const Reference &ref = refs.takeFirst();
         m_fileName = ref.fileName();
         m_lineNumber = ref.lineNumber();
-        m_extraRefs = refs;
+        if (m_rare.constData() || !refs.isEmpty())
+            rare().extraRefs = refs;
     } else {
         clearReferences();
     }
@@ -83,7 +85,8 @@ TranslatorMessage::References TranslatorMessage::allReferences() const
     References refs;
     if (!m_fileName.isEmpty()) {
         refs.append(Reference(m_fileName, m_lineNumber));
-        refs += m_extraRefs;
+        if (m_rare)
+            refs += m_rare->extraRefs;
     }
     return refs;
 }
@@ -91,22 +94,29 @@ TranslatorMessage::References TranslatorMessage::allReferences() const
 
 bool TranslatorMessage::hasExtra(const QString &key) const
 {
-    return m_extra.contains(key);
+    return m_rare && m_rare->extra.contains(key);
 }
 
 QString TranslatorMessage::extra(const QString &key) const
 {
-    return m_extra[key];
+    return m_rare ? m_rare->extra.value(key) : QString();
 }
 
 void TranslatorMessage::setExtra(const QString &key, const QString &value)
 {
-    m_extra[key] = value;
+    rare().extra[key] = value;
 }
 
 void TranslatorMessage::unsetExtra(const QString &key)
 {
-    m_extra.remove(key);
+    if (m_rare.constData() && m_rare.constData()->extra.contains(key))
+        m_rare->extra.remove(key);
+}
+
+const TranslatorMessage::ExtraData &TranslatorMessage::extras() const
+{
+    static const ExtraData noExtras;
+    return m_rare ? m_rare->extra : noExtras;
 }
 
 void TranslatorMessage::dump() const
@@ -116,15 +126,15 @@ void TranslatorMessage::dump() const
         << "\nContext           : " << m_context
         << "\nSource            : " << m_sourcetext
         << "\nComment           : " << m_comment
-        << "\nUserData          : " << m_userData
-        << "\nExtraComment      : " << m_extraComment
-        << "\nTranslatorComment : " << m_translatorComment
+        << "\nUserData          : " << userData()
+        << "\nExtraComment      : " << extraComment()
+        << "\nTranslatorComment : " << translatorComment()
         << "\nTranslations      : " << m_translations
         << "\nFileName          : " << m_fileName
         << "\nLineNumber        : " << m_lineNumber
         << "\nType              : " << m_type
         << "\nPlural            : " << m_plural
-        << "\nExtra             : " << m_extra;
+        << "\nExtra             : " << extras();
 }
 
 
@@ -6,7 +6,7 @@
 #include <QtCore/QByteArray>
 #include <QtCore/QDebug>
 #include <QtCore/QRegularExpression>
-#include <QtCore/QTextStream>
+#include <QtCore/QStringConverter>
 
 #include <QtCore/QXmlStreamReader>
 
@@ -27,13 +27,18 @@ QDebug &operator<<(QDebug &d, const QXmlStreamAttribute &attr)
 class TSReader : public QXmlStreamReader
 {
 public:
+    typedef std::function<void(TranslatorMessage &)> MessageHandler;
+
     TSReader(QIODevice &dev, ConversionData &cd)
-      : QXmlStreamReader(&dev), m_cd(cd)
+      : QXmlStreamReader(&dev), m_cd(cd), m_messageCount(0)
     {}
 
     // the "real thing"
     bool read(Translator &translator);
 
+    // Passes the messages to the handler instead of appending them to the translator
+    void setMessageHandler(const MessageHandler &handler) { m_messageHandler = handler; }
+
 private:
     bool elementStarts(const QString &str) const
     {
@@ -53,6 +58,8 @@ private:
     void handleError();
 
     ConversionData &m_cd;
+    MessageHandler m_messageHandler;
+    int m_messageCount;
 };
 
 void TSReader::handleError()
@@ -210,6 +217,7 @@ bool TSReader::read(Translator &translator)
             //qDebug() << "TS " << attributes();
             QHash<QString, int> currentLine;
             QString currentFile;
+            QSet<QString> fileNames; // to share one copy of each file name among the messages
             bool maybeRelative = false, maybeAbsolute = false;
 
             QXmlStreamAttributes atts = attributes();
@@ -285,7 +293,11 @@ bool TSReader::read(Translator &translator)
                                 if (isEndElement()) {
                                     // </message> found, finish local loop
                                     msg.setReferences(refs);
-                                    translator.append(msg);
+                                    ++m_messageCount;
+                                    if (m_messageHandler)
+                                        m_messageHandler(msg);
+                                    else
+                                        translator.append(msg);
                                     break;
                                 } else if (isWhiteSpace()) {
                                     // ignore these, just whitespace
@@ -313,6 +325,7 @@ bool TSReader::read(Translator &translator)
                                         fileName = currentMsgFile;
                                         maybeRelative = true;
                                     } else {
+                                        fileName = *fileNames.insert(fileName);
                                         if (refs.isEmpty())
                                             currentFile = fileName;
                                         currentMsgFile = fileName;
@@ -388,7 +401,7 @@ bool TSReader::read(Translator &translator)
                     handleError();
                 }
                 // if the file is empty adopt AbsoluteLocation (default location type for Translator)
-                if (translator.messageCount() == 0)
+                if (m_messageCount == 0)
                     maybeAbsolute = true;
                 translator.setLocationsType(maybeRelative ? Translator::RelativeLocations :
                                             maybeAbsolute ? Translator::AbsoluteLocations :
@@ -405,62 +418,152 @@ bool TSReader::read(Translator &translator)
     return true;
 }
 
+/*
+  Buffers the UTF-8 encoded output, so the device sees a few large writes
+  instead of one per token.
+*/
+class TSWriter
+{
+public:
+    explicit TSWriter(QIODevice &dev)
+      : m_dev(dev), m_encoder(QStringConverter::Utf8)
+    {
+        m_buffer.reserve(BufferSize + BufferSize / 4);
+    }
+    ~TSWriter() { flush(); }
+
+    // str must be plain ASCII
+    TSWriter &operator<<(const char *str)
+    {
+        m_buffer.append(str);
+        return *this;
+    }
+    TSWriter &operator<<(const QString &str)
+    {
+        append(QStringView(str));
+        return *this;
+    }
+
+    void append(QLatin1String str)
+    {
+        m_buffer.append(str.data(), str.size());
+    }
+    void append(QStringView str)
+    {
+        const qsizetype size = m_buffer.size();
+        m_buffer.resize(size + m_encoder.requiredSpace(str.size()));
+        const char *end = m_encoder.appendToBuffer(m_buffer.data() + size, str);
+        m_buffer.resize(end - m_buffer.constData());
+        if (m_buffer.size() >= BufferSize)
+            flush();
+    }
+
+    void flush()
+    {
+        if (!m_buffer.isEmpty()) {
+            m_dev.write(m_buffer);
+            m_buffer.resize(0);
+        }
+    }
+
+private:
+    enum { BufferSize = 256 * 1024 };
+
+    QIODevice &m_dev;
+    QStringEncoder m_encoder;
+    QByteArray m_buffer;
+};
+
 static QString numericEntity(int ch)
 {
     return QString(ch <= 0x20 ? QLatin1String("<byte value=\"x%1\"/>")
         : QLatin1String("&#x%1;")) .arg(ch, 0, 16);
 }
 
-static QString protect(const QString &str)
+static inline bool needsProtection(char16_t c)
 {
-    QString result;
-    result.reserve(str.length() * 12 / 10);
-    for (int i = 0; i != str.size(); ++i) {
-        const QChar ch = str[i];
-        uint c = ch.unicode();
+    if (c >= 0x80)
+        return QChar::isSpace(c);
+    if (c < 0x20)
+        return c != '\n' && c != '\t';
+    return c == '\"' || c == '&' || c == '>' || c == '<' || c == '\'';
+}
+
+/*
+  Appends str to out with XML special characters escaped. Runs of characters
+  that need no escaping are appended in one go.
+*/
+template <typename Out>
+static void protect(Out &out, QStringView str)
+{
+    const char16_t *data = str.utf16();
+    const qsizetype size = str.size();
+    qsizetype start = 0;
+    for (qsizetype i = 0; i != size; ++i) {
+        const char16_t c = data[i];
+        if (!needsProtection(c)) // this also covers surrogates
+            continue;
+        if (i != start)
+            out.append(str.mid(start, i - start));
+        start = i + 1;
         switch (c) {
         case '\"':
-            result += QLatin1String("&quot;");
+            out.append(QLatin1String("&quot;"));
             break;
         case '&':
-            result += QLatin1String("&amp;");
+            out.append(QLatin1String("&amp;"));
             break;
         case '>':
-            result += QLatin1String("&gt;");
+            out.append(QLatin1String("&gt;"));
             break;
         case '<':
-            result += QLatin1String("&lt;");
+            out.append(QLatin1String("&lt;"));
             break;
         case '\'':
-            result += QLatin1String("&apos;");
+            out.append(QLatin1String("&apos;"));
             break;
         default:
-            if ((c < 0x20 || (ch > QChar(0x7f) && ch.isSpace())) && c != '\n' && c != '\t')
-                result += numericEntity(c);
-            else // this also covers surrogates
-                result += QChar(c);
+            out.append(QStringView(numericEntity(c)));
         }
     }
-    return result;
+    if (start != size)
+        out.append(str.mid(start));
+}
+
+struct Protected
+{
+    QStringView str;
+};
+
+static inline Protected protect(QStringView str)
+{
+    return { str };
 }
 
-static void writeExtras(QTextStream &t, const char *indent,
-                        const TranslatorMessage::ExtraData &extras, QRegularExpression drops)
+static inline TSWriter &operator<<(TSWriter &t, Protected p)
+{
+    protect(t, p.str);
+    return t;
+}
+
+static void writeExtras(TSWriter &t, const char *indent,
+                        const TranslatorMessage::ExtraData &extras, const QRegularExpression &drops)
 {
     QStringList outs;
     for (auto it = extras.cbegin(), end = extras.cend(); it != end; ++it) {
         if (!drops.match(it.key()).hasMatch()) {
-            outs << (QStringLiteral("<extra-") + it.key() + QLatin1Char('>')
-                     + protect(it.value())
-                     + QStringLiteral("</extra-") + it.key() + QLatin1Char('>'));
+            QString out = QStringLiteral("<extra-") + it.key() + QLatin1Char('>');
+            protect(out, it.value());
+            out += QStringLiteral("</extra-") + it.key() + QLatin1Char('>');
+            outs << out;
         }
     }
     outs.sort();
     for (const QString &out : qAsConst(outs))
-        t << indent << out << Qt::endl;
+        t << indent << out << "\n";
 }
 
-static void writeVariants(QTextStream &t, const char *indent, const QString &input)
+static void writeVariants(TSWriter &t, const char *indent, const QString &input)
 {
     int offset;
     if ((offset = input.indexOf(QChar(Translator::BinaryVariantSeparator))) >= 0) {
@@ -468,7 +571,7 @@ static void writeVariants(QTextStream &t, const char *indent, const QString &inp
         int start = 0;
         forever {
             t << "\n    " << indent << "<lengthvariant>"
-              << protect(input.mid(start, offset - start))
+              << protect(QStringView(input).mid(start, offset - start))
               << "</lengthvariant>";
             if (offset == input.length())
                 break;
@@ -483,11 +586,8 @@ static void writeVariants(QTextStream &t, const char *indent, const QString &inp
     }
 }
 
-bool saveTS(const Translator &translator, QIODevice &dev, ConversionData &cd)
+static void writeHeader(TSWriter &t, const Translator &translator, const QRegularExpression &drops)
 {
-    bool result = true;
-    QTextStream t(&dev);
-
     // The xml prolog allows processors to easily detect the correct encoding
     t << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<!DOCTYPE TS>\n";
 
@@ -509,18 +609,151 @@ bool saveTS(const Translator &translator, QIODevice &dev, ConversionData &cd)
         t << "</dependencies>\n";
     }
 
+    writeExtras(t, "    ", translator.extras(), drops);
+}
+
+static void writeContextStart(TSWriter &t, const QString &context)
+{
+    t << "<context>\n"
+         "    <name>"
+      << protect(context)
+      << "</name>\n";
+}
+
+// Obsolete messages without a translation are not worth saving
+static bool isNoise(const TranslatorMessage &msg)
+{
+    return (msg.type() == TranslatorMessage::Obsolete || msg.type() == TranslatorMessage::Vanished)
+            && msg.translation().isEmpty();
+}
+
+// Relative locations are written as deltas to the previous ones
+struct TSLocationState
+{
+    QHash<QString, int> currentLine;
+    QString currentFile;
+};
+
+static void writeMessage(TSWriter &t, const TranslatorMessage &msg,
+                         Translator::LocationsType locationsType, const ConversionData &cd,
+                         const QRegularExpression &drops, TSLocationState &state)
+{
+    t << "    <message";
+    if (!msg.id().isEmpty())
+        t << " id=\"" << msg.id() << "\"";
+    if (msg.isPlural())
+        t << " numerus=\"yes\"";
+    t << ">\n";
+    if (locationsType != Translator::NoLocations) {
+        QString cfile = state.currentFile;
+        bool first = true;
+        for (const TranslatorMessage::Reference &ref : msg.allReferences()) {
+            QString fn = cd.m_targetDir.relativeFilePath(ref.fileName())
+                        .replace(QLatin1Char('\\'),QLatin1Char('/'));
+            int ln = ref.lineNumber();
+            QString ld;
+            if (locationsType == Translator::RelativeLocations) {
+                if (ln != -1) {
+                    int dlt = ln - state.currentLine[fn];
+                    if (dlt >= 0)
+                        ld.append(QLatin1Char('+'));
+                    ld.append(QString::number(dlt));
+                    state.currentLine[fn] = ln;
+                }
+
+                if (fn != cfile) {
+                    if (first)
+                        state.currentFile = fn;
+                    cfile = fn;
+                } else {
+                    fn.clear();
+                }
+                first = false;
+            } else {
+                if (ln != -1)
+                    ld = QString::number(ln);
+            }
+            t << "        <location";
+            if (!fn.isEmpty())
+                t << " filename=\"" << fn << "\"";
+            if (!ld.isEmpty())
+                t << " line=\"" << ld << "\"";
+            t << "/>\n";
+        }
+    }
+
+    t << "        <source>"
+      << protect(msg.sourceText())
+      << "</source>\n";
+
+    const QString oldSourceText = msg.oldSourceText();
+    if (!oldSourceText.isEmpty())
+        t << "        <oldsource>" << protect(oldSourceText) << "</oldsource>\n";
+
+    if (!msg.comment().isEmpty()) {
+        t << "        <comment>"
+          << protect(msg.comment())
+          << "</comment>\n";
+    }
+
+    const QString oldComment = msg.oldComment();
+    if (!oldComment.isEmpty())
+        t << "        <oldcomment>" << protect(oldComment) << "</oldcomment>\n";
+
+    const QString extraComment = msg.extraComment();
+    if (!extraComment.isEmpty())
+        t << "        <extracomment>" << protect(extraComment)
+          << "</extracomment>\n";
+
+    const QString translatorComment = msg.translatorComment();
+    if (!translatorComment.isEmpty())
+        t << "        <translatorcomment>" << protect(translatorComment)
+          << "</translatorcomment>\n";
+
+    t << "        <translation";
+    if (msg.type() == TranslatorMessage::Unfinished)
+        t << " type=\"unfinished\"";
+    else if (msg.type() == TranslatorMessage::Vanished)
+        t << " type=\"vanished\"";
+    else if (msg.type() == TranslatorMessage::Obsolete)
+        t << " type=\"obsolete\"";
+    if (msg.isPlural()) {
+        t << ">";
+        const QStringList &translns = msg.translations();
+        for (int j = 0; j < translns.count(); ++j) {
+            t << "\n            <numerusform";
+            writeVariants(t, "            ", translns[j]);
+            t << "</numerusform>";
+        }
+        t << "\n        ";
+    } else {
+        writeVariants(t, "        ", msg.translation());
+    }
+    t << "</translation>\n";
+
+    writeExtras(t, "        ", msg.extras(), drops);
+
+    const QString userData = msg.userData();
+    if (!userData.isEmpty())
+        t << "        <userdata>" << userData << "</userdata>\n";
+    t << "    </message>\n";
+}
+
+bool saveTS(const Translator &translator, QIODevice &dev, ConversionData &cd)
+{
+    bool result = true;
+    TSWriter t(dev);
+
     QRegularExpression drops(QRegularExpression::anchoredPattern(cd.dropTags().join(QLatin1Char('|'))));
 
-    writeExtras(t, "    ", translator.extras(), drops);
+    writeHeader(t, translator, drops);
 
     QHash<QString, QList<TranslatorMessage> > messageOrder;
     QList<QString> contextOrder;
     for (const TranslatorMessage &msg : translator.messages()) {
         // no need for such noise
-        if ((msg.type() == TranslatorMessage::Obsolete || msg.type() == TranslatorMessage::Vanished)
-            && msg.translation().isEmpty()) {
+        if (isNoise(msg))
             continue;
-        }
 
         QList<TranslatorMessage> &context = messageOrder[msg.context()];
         if (context.isEmpty())
@@ -530,114 +763,85 @@ bool saveTS(const Translator &translator, QIODevice &dev, ConversionData &cd)
     if (cd.sortContexts())
         std::sort(contextOrder.begin(), contextOrder.end());
 
-    QHash<QString, int> currentLine;
-    QString currentFile;
+    TSLocationState state;
     for (const QString &context : qAsConst(contextOrder)) {
-        t << "<context>\n"
-             "    <name>"
-          << protect(context)
-          << "</name>\n";
-        for (const TranslatorMessage &msg : qAsConst(messageOrder[context])) {
-            //msg.dump();
-
-                t << "    <message";
-                if (!msg.id().isEmpty())
-                    t << " id=\"" << msg.id() << "\"";
-                if (msg.isPlural())
-                    t << " numerus=\"yes\"";
-                t << ">\n";
-                if (translator.locationsType() != Translator::NoLocations) {
-                    QString cfile = currentFile;
-                    bool first = true;
-                    for (const TranslatorMessage::Reference &ref : msg.allReferences()) {
-                        QString fn = cd.m_targetDir.relativeFilePath(ref.fileName())
-                                    .replace(QLatin1Char('\\'),QLatin1Char('/'));
-                        int ln = ref.lineNumber();
-                        QString ld;
-                        if (translator.locationsType() == Translator::RelativeLocations) {
-                            if (ln != -1) {
-                                int dlt = ln - currentLine[fn];
-                                if (dlt >= 0)
-                                    ld.append(QLatin1Char('+'));
-                                ld.append(QString::number(dlt));
-                                currentLine[fn] = ln;
-                            }
-
-                            if (fn != cfile) {
-                                if (first)
-                                    currentFile = fn;
-                                cfile = fn;
-                            } else {
-                                fn.clear();
-                            }
-                            first = false;
-                        } else {
-                            if (ln != -1)
-                                ld = QString::number(ln);
-                        }
-                        t << "        <location";
-                        if (!fn.isEmpty())
-                            t << " filename=\"" << fn << "\"";
-                        if (!ld.isEmpty())
-                            t << " line=\"" << ld << "\"";
-                        t << "/>\n";
-                    }
-                }
-
-                t << "        <source>"
-                  << protect(msg.sourceText())
-                  << "</source>\n";
-
-                if (!msg.oldSourceText().isEmpty())
-                    t << "        <oldsource>" << protect(msg.oldSourceText()) << "</oldsource>\n";
-
-                if (!msg.comment().isEmpty()) {
-                    t << "        <comment>"
-                      << protect(msg.comment())
-                      << "</comment>\n";
-                }
-
-                    if (!msg.oldComment().isEmpty())
-                        t << "        <oldcomment>" << protect(msg.oldComment()) << "</oldcomment>\n";
-
-                    if (!msg.extraComment().isEmpty())
-                        t << "        <extracomment>" << protect(msg.extraComment())
-                          << "</extracomment>\n";
-
-                    if (!msg.translatorComment().isEmpty())
-                        t << "        <translatorcomment>" << protect(msg.translatorComment())
-                          << "</translatorcomment>\n";
-
-                t << "        <translation";
-                if (msg.type() == TranslatorMessage::Unfinished)
-                    t << " type=\"unfinished\"";
-                else if (msg.type() == TranslatorMessage::Vanished)
-                    t << " type=\"vanished\"";
-                else if (msg.type() == TranslatorMessage::Obsolete)
-                    t << " type=\"obsolete\"";
-                if (msg.isPlural()) {
-                    t << ">";
-                    const QStringList &translns = msg.translations();
-                    for (int j = 0; j < translns.count(); ++j) {
-                        t << "\n            <numerusform";
-                        writeVariants(t, "            ", translns[j]);
-                        t << "</numerusform>";
-                    }
-                    t << "\n        ";
-                } else {
-                    writeVariants(t, "        ", msg.translation());
-                }
-                t << "</translation>\n";
+        writeContextStart(t, context);
+        for (const TranslatorMessage &msg : qAsConst(messageOrder[context]))
+            writeMessage(t, msg, translator.locationsType(), cd, drops, state);
+        t << "</context>\n";
+    }
 
-                writeExtras(t, "        ", msg.extras(), drops);
+    t << "</TS>\n";
+    return result;
+}
 
-                if (!msg.userData().isEmpty())
-                    t << "        <userdata>" << msg.userData() << "</userdata>\n";
-                t << "    </message>\n";
+/*
+  Converts a TS file to a TS file one message at a time, so the memory use
+  does not grow with the file size. Messages are written in input order, and
+  only adjacent messages of the same context are grouped.
+
+  The location type must be known before the first message is written. If
+  none is given, it is detected in a first pass over the input, or the
+  default is used when the input cannot be rewound.
+*/
+bool streamTS(QIODevice &in, QIODevice &out, ConversionData &cd,
+              Translator::LocationsType locationsType,
+              const Translator::HeaderHandler &headerHandler,
+              const Translator::MessageFilter &filter)
+{
+    if (locationsType == Translator::DefaultLocations) {
+        locationsType = Translator::AbsoluteLocations;
+        if (!in.isSequential()) {
+            Translator scanned;
+            TSReader scanner(in, cd);
+            scanner.setMessageHandler([](TranslatorMessage &) {});
+            if (!scanner.read(scanned))
+                return false;
+            locationsType = scanned.locationsType();
+            if (!in.reset()) {
+                cd.appendError(QString::fromLatin1("Cannot rewind %1: %2")
+                    .arg(cd.m_sourceFileName, in.errorString()));
+                return false;
+            }
         }
-        t << "</context>\n";
     }
 
+    QRegularExpression drops(QRegularExpression::anchoredPattern(cd.dropTags().join(QLatin1Char('|'))));
+    Translator header;
+    TSWriter t(out);
+    bool started = false;
+    bool inContext = false;
+    QString context;
+    TSLocationState state;
+    const auto start = [&]() {
+        if (!started) {
+            started = true;
+            if (headerHandler)
+                headerHandler(header);
+            writeHeader(t, header, drops);
+        }
+    };
+
+    TSReader reader(in, cd);
+    reader.setMessageHandler([&](TranslatorMessage &msg) {
+        // The header elements precede the contexts
+        start();
+        if ((filter && !filter(msg)) || isNoise(msg))
+            return;
+        if (!inContext || msg.context() != context) {
+            if (inContext)
+                t << "</context>\n";
+            context = msg.context();
+            inContext = true;
+            writeContextStart(t, context);
+        }
+        writeMessage(t, msg, locationsType, cd, drops, state);
+    });
+    const bool result = reader.read(header);
+
+    start();
+    if (inContext)
+        t << "</context>\n";
     t << "</TS>\n";
     return result;
 }
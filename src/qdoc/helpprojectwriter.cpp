@@ -19,9 +19,54 @@
 #include <QtCore/qcryptographichash.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qiodevice.h>
 
 QT_BEGIN_NAMESPACE
 
+/*
+    A write-only device that forwards everything written to it to
+    the underlying file and feeds the same bytes into a SHA1 hash,
+    so the .sha1 file can be written without reading the qhp back.
+
+    The file must not be opened in text mode, as the hash would then
+    miss the line ending conversion. The device does that conversion
+    itself, before hashing.
+ */
+class HashingFileDevice : public QIODevice
+{
+public:
+    explicit HashingFileDevice(QFile *file)
+        : m_file(file), m_hash(QCryptographicHash::Sha1)
+    {
+        open(QIODevice::WriteOnly);
+    }
+
+    QByteArray result() const { return m_hash.result(); }
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+    qint64 writeData(const char *data, qint64 len) override
+    {
+#ifdef Q_OS_WIN
+        QByteArray converted(data, len);
+        converted.replace('\n', "\r\n");
+        if (m_file->write(converted) != converted.size())
+            return -1;
+        m_hash.addData(converted);
+        return len;
+#else
+        const qint64 written = m_file->write(data, len);
+        if (written > 0)
+            m_hash.addData(QByteArrayView(data, written));
+        return written;
+#endif
+    }
+
+private:
+    QFile *m_file {};
+    QCryptographicHash m_hash;
+};
+
 HelpProjectWriter::HelpProjectWriter(const QString &defaultFileName, Generator *g)
 {
     reset(defaultFileName, g);
@@ -217,15 +262,16 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
     // Only add nodes to the set for each subproject if they match a selector.
     // Those that match will be listed in the table of contents.
 
-    for (int i = 0; i < project.m_subprojects.length(); i++) {
-        SubProject subproject = project.m_subprojects[i];
+    // All subprojects are filled during this single traversal; operate on
+    // them in place so their node hashes are not detached for every node.
+    for (SubProject &subproject : project.m_subprojects) {
         // No selectors: accept all nodes.
         if (subproject.m_selectors.isEmpty()) {
-            project.m_subprojects[i].m_nodes[objName] = node;
+            subproject.m_nodes[objName] = node;
         } else if (subproject.m_selectors.contains(node->nodeType())) {
             // Add all group members for '[group|module|qmlmodule]:name' selector
             if (node->isCollectionNode()) {
-                if (project.m_subprojects[i].m_groups.contains(node->name().toLower())) {
+                if (subproject.m_groups.contains(node->name().toLower())) {
                     const auto *cn = static_cast<const CollectionNode *>(node);
                     const auto members = cn->members();
                     for (const Node *m : members) {
@@ -233,17 +279,17 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
                             continue;
                         QString memberName =
                                 m->isTextPageNode() ? m->fullTitle() : m->fullDocumentName();
-                        project.m_subprojects[i].m_nodes[memberName] = m;
+                        subproject.m_nodes[memberName] = m;
                     }
                     continue;
-                } else if (!project.m_subprojects[i].m_groups.isEmpty()) {
+                } else if (!subproject.m_groups.isEmpty()) {
                     continue; // Node does not represent specified group(s)
                 }
             } else if (node->isTextPageNode()) {
                 if (node->isExternalPage() || node->fullTitle().isEmpty())
                     continue;
             }
-            project.m_subprojects[i].m_nodes[objName] = node;
+            subproject.m_nodes[objName] = node;
         }
     }
 
@@ -283,6 +329,7 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
         {
             const auto *enumNode = static_cast<const EnumNode *>(node);
             const auto items = enumNode->items();
+            const QString ref = m_gen->fullDocumentLocation(node, false);
             for (const auto &item : items) {
                 if (enumNode->itemAccess(item.name()) == Access::Private)
                     continue;
@@ -294,7 +341,6 @@ bool HelpProjectWriter::generateSection(HelpProject &project, QXmlStreamWriter &
                 } else {
                     name = id = item.name();
                 }
-                QString ref = m_gen->fullDocumentLocation(node, false);
                 project.m_keywords.append(Keyword(name, id, ref));
             }
         }
@@ -459,16 +505,13 @@ void HelpProjectWriter::generate()
         generateProject(project);
 }
 
-void HelpProjectWriter::writeHashFile(QFile &file)
+void HelpProjectWriter::writeHashFile(const QString &fileName, const QByteArray &hash)
 {
-    QCryptographicHash hash(QCryptographicHash::Sha1);
-    hash.addData(&file);
-
-    QFile hashFile(file.fileName() + ".sha1");
+    QFile hashFile(fileName + ".sha1");
     if (!hashFile.open(QFile::WriteOnly | QFile::Text))
         return;
 
-    hashFile.write(hash.result().toHex());
+    hashFile.write(hash.toHex());
     hashFile.close();
 }
 
@@ -584,10 +627,12 @@ void HelpProjectWriter::generateProject(HelpProject &project)
     project.m_keywords.clear();
 
     QFile file(m_outputDir + QDir::separator() + project.m_fileName);
-    if (!file.open(QFile::WriteOnly | QFile::Text))
+    if (!file.open(QFile::WriteOnly))
         return;
 
-    QXmlStreamWriter writer(&file);
+    // The SHA1 of the project file is computed while it is written.
+    HashingFileDevice device(&file);
+    QXmlStreamWriter writer(&device);
     writer.setAutoFormatting(true);
     writer.writeStartDocument();
     writer.writeStartElement("QtHelpProject");
@@ -639,9 +684,7 @@ void HelpProjectWriter::generateProject(HelpProject &project)
 
     generateSections(project, writer, rootNode);
 
-    for (int i = 0; i < project.m_subprojects.length(); i++) {
-        SubProject subproject = project.m_subprojects[i];
-
+    for (const SubProject &subproject : qAsConst(project.m_subprojects)) {
         if (subproject.m_type == QLatin1String("manual")) {
 
             const Node *indexPage = m_qdb->findNodeForTarget(subproject.m_indexTitle, nullptr);
@@ -784,8 +827,9 @@ void HelpProjectWriter::generateProject(HelpProject &project)
     writer.writeEndElement(); // filterSection
     writer.writeEndElement(); // QtHelpProject
     writer.writeEndDocument();
-    writeHashFile(file);
+    device.close();
     file.close();
+    writeHashFile(file.fileName(), device.result());
 }
 
 QT_END_NAMESPACE
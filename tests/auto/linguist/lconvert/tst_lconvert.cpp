@@ -3,6 +3,7 @@
 
 #include <QtTest/QtTest>
 #include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
 
 class tst_lconvert : public QObject
 {
@@ -23,6 +24,8 @@ private slots:
     void roundtrips();
     void chains_data();
     void chains();
+    void streamsInPlace_data();
+    void streamsInPlace();
     void merge();
 
 private:
@@ -234,6 +237,15 @@ void tst_lconvert::chains_data()
     QTest::newRow("no-untranslated") << "untranslated.ts" << "untranslated.ts.out"
                                      << QStringList({"ts", "ts"})
                                      << QList<QStringList>({QStringList("-no-untranslated")});
+    QTest::newRow("stream") << "test20.ts" << "test20.ts"
+                            << QStringList({"ts", "ts"})
+                            << QList<QStringList>({QStringList("-stream")});
+    QTest::newRow("stream length variants") << "variants.ts" << "variants.ts"
+                                            << QStringList({"ts", "ts"})
+                                            << QList<QStringList>({QStringList("-stream")});
+    QTest::newRow("stream no-untranslated") << "untranslated.ts" << "untranslated.ts.out"
+                                            << QStringList({"ts", "ts"})
+                                            << QList<QStringList>({QStringList({"-stream", "-no-untranslated"})});
 }
 
 void tst_lconvert::chains()
@@ -246,6 +258,41 @@ void tst_lconvert::chains()
     convertChain(inFileName, outFileName, stations, args);
 }
 
+void tst_lconvert::streamsInPlace_data()
+{
+    QTest::addColumn<QString>("inFileName");
+    QTest::addColumn<QString>("outFileName");
+    QTest::addColumn<QStringList>("args");
+
+    QTest::newRow("stream in place") << "test20.ts" << "test20.ts" << QStringList();
+    QTest::newRow("stream in place no-untranslated")
+            << "untranslated.ts" << "untranslated.ts.out" << QStringList("-no-untranslated");
+}
+
+void tst_lconvert::streamsInPlace()
+{
+    QFETCH(QString, inFileName);
+    QFETCH(QString, outFileName);
+    QFETCH(QStringList, args);
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString fileName = tempDir.filePath(inFileName);
+    QVERIFY(QFile::copy(dataDir + inFileName, fileName));
+    QVERIFY(QFile::setPermissions(fileName, QFile::ReadOwner | QFile::WriteOwner));
+
+    QProcess cvt;
+    cvt.start(lconvert, QStringList("-stream") << args << "-i" << fileName << "-o" << fileName);
+    QVERIFY2(cvt.waitForStarted(), qPrintable(cvt.errorString()));
+    doWait(&cvt, 0);
+    if (QTest::currentTestFailed())
+        return;
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    doCompare(&file, dataDir + outFileName);
+}
+
 void tst_lconvert::roundtrips_data()
 {
     QTest::addColumn<QString>("fileName");
@@ -0,0 +1,11 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+namespace Foo {
+#include "direct.h"
+#include <shadowed.h>
+}
+
+#include "indirect.h"
+
+const char *mainText = QT_TRANSLATE_NOOP("main", "main text");
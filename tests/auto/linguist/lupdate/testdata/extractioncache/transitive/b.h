@@ -0,0 +1,8 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+namespace B {
+#include "c.h"
+}
+
+const char *bText = QT_TRANSLATE_NOOP("b", "b text");
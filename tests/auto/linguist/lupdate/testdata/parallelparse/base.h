@@ -0,0 +1,16 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef BASE_H
+#define BASE_H
+
+class QObject {};
+
+class Base : public QObject
+{
+    Q_OBJECT
+public:
+    QString name() const { return tr("Base name"); }
+};
+
+#endif
@@ -0,0 +1,10 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+// Included both inside a namespace and at the top level.
+class Inlined : public QObject
+{
+    Q_OBJECT
+public:
+    QString text() const { return tr("Inlined"); }
+};
@@ -0,0 +1,13 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "shared.h"
+
+namespace Outer {
+#include "inlined.h"
+}
+
+QString outer()
+{
+    return Outer::Inlined::tr("Outer text");
+}
@@ -0,0 +1,18 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef PING_H
+#define PING_H
+
+// Ping and pong include each other.
+#include "pong.h"
+
+class Ping
+{
+    Q_DECLARE_TR_FUNCTIONS(Ping)
+public:
+    Pong *pong;
+    QString text() const;
+};
+
+#endif
@@ -0,0 +1,15 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "pong.h"
+#include "shared.h"
+
+QString Pong::text() const
+{
+    return tr("Pong");
+}
+
+QString Shared::Widget::text() const
+{
+    return tr("Shared text");
+}
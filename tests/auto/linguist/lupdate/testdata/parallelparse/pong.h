@@ -0,0 +1,22 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef PONG_H
+#define PONG_H
+
+#include "ping.h"
+
+class Pong
+{
+    Q_DECLARE_TR_FUNCTIONS(Pong)
+public:
+    Ping *ping;
+    QString text() const;
+};
+
+namespace Game {
+using ::Ping;
+using ::Pong;
+}
+
+#endif
@@ -0,0 +1,28 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef SHARED_H
+#define SHARED_H
+
+#include "base.h"
+
+namespace Shared {
+
+class Widget : public Base
+{
+    Q_OBJECT
+public:
+    QString title() const { return tr("Shared title"); }
+    QString text() const;
+};
+
+// Lacks Q_OBJECT, which is reported once however many files use it
+class Plain : public QObject
+{
+public:
+    QString label() const { return tr("Plain label"); }
+};
+
+}
+
+#endif
@@ -0,0 +1,10 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "inlined.h"
+#include "ping.h"
+
+QString topLevel()
+{
+    return Inlined::tr("Top-level text") + Game::Pong::tr("Game text");
+}
@@ -0,0 +1,12 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "shared.h"
+#include "ping.h"
+
+class Widget1 : public Shared::Widget
+{
+    Q_OBJECT
+public:
+    QString text() const { return tr("Widget 1") + Ping::tr("Ping 1") + Pong::tr("Pong 1"); }
+};
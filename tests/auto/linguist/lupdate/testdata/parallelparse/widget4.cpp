@@ -0,0 +1,12 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "pong.h"
+#include "shared.h"
+
+class Widget4 : public Shared::Widget
+{
+    Q_OBJECT
+public:
+    QString text() const { return tr("Widget 4") + Ping::tr("Ping 4") + Pong::tr("Pong 4"); }
+};
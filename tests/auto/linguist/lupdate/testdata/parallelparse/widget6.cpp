@@ -0,0 +1,13 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "pong.h"
+#include "shared.h"
+
+class Widget6 : public Shared::Widget
+{
+    Q_OBJECT
+public:
+    QString text() const { return tr("Widget 6") + Ping::tr("Ping 6") + Pong::tr("Pong 6"); }
+    QString label() const { return Shared::Plain::tr("Plain 6"); }
+};
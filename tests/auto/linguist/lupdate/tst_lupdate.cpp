@@ -11,6 +11,7 @@
 #include <QtCore/QFile>
 #include <QtCore/private/qconfig_p.h>
 #include <QtCore/QSet>
+#include <QtCore/QTemporaryDir>
 
 #include <QtTest/QtTest>
 #include <QtTools/private/qttools-config_p.h>
@@ -26,6 +27,9 @@ public:
 private slots:
     void good_data();
     void good();
+    void parallelParsing();
+    void extractionCache();
+    void extractionCacheBlacklisting();
 #if CHECK_SIMTEXTH
     void simtexth();
     void simtexth_data();
@@ -37,6 +41,7 @@ private:
 
     void doCompare(QStringList actual, const QString &expectedFn, bool err);
     void doCompare(const QString &actualFn, const QString &expectedFn, bool err);
+    bool runLupdate(const QString &workDir, const QStringList &arguments, QString *output);
 };
 
 
@@ -331,6 +336,173 @@ void tst_lupdate::good()
     }
 }
 
+bool tst_lupdate::runLupdate(const QString &workDir, const QStringList &arguments,
+                             QString *output)
+{
+    QProcess proc;
+    proc.setWorkingDirectory(workDir);
+    proc.setProcessChannelMode(QProcess::MergedChannels);
+    const QString command = m_cmdLupdate + ' ' + arguments.join(' ');
+    proc.start(m_cmdLupdate, arguments, QIODevice::ReadWrite | QIODevice::Text);
+    if (!proc.waitForStarted()) {
+        *output = command + QLatin1String(": ") + proc.errorString();
+        return false;
+    }
+    if (!proc.waitForFinished(30000)) {
+        *output = command + QLatin1String(": timed out");
+        return false;
+    }
+    *output = command + QLatin1Char('\n') + QString::fromLocal8Bit(proc.readAll());
+    return proc.exitStatus() == QProcess::NormalExit && !proc.exitCode();
+}
+
+// Parsing on several threads must give what parsing on one does.
+void tst_lupdate::parallelParsing()
+{
+    const QString dir = m_basePath + QLatin1String("parallelparse");
+    QTemporaryDir outDir;
+    QVERIFY(outDir.isValid());
+
+    const QStringList sources = QDir(dir).entryList({ QLatin1String("*.cpp"),
+                                                      QLatin1String("*.h") },
+                                                    QDir::Files, QDir::Name);
+    QVERIFY(!sources.isEmpty());
+    const auto arguments = [&](int threads, const QString &tsFile) {
+        return QStringList({ QLatin1String("-silent"), QLatin1String("-j"),
+                             QString::number(threads) })
+                + sources + QStringList({ QLatin1String("-ts"), outDir.filePath(tsFile) });
+    };
+
+    // The first line of the output is the command line
+    const auto diagnostics = [](const QString &output) {
+        return output.mid(output.indexOf(QLatin1Char('\n')) + 1);
+    };
+
+    QString output;
+    QVERIFY2(runLupdate(dir, arguments(1, QLatin1String("serial.ts")), &output),
+             qPrintable(output));
+    const QString expectedDiagnostics = diagnostics(output);
+    QCOMPARE(expectedDiagnostics.count(QLatin1String("lacks Q_OBJECT")), 1);
+    QFile serial(outDir.filePath(QLatin1String("serial.ts")));
+    QVERIFY(serial.open(QIODevice::ReadOnly));
+    const QByteArray expected = serial.readAll();
+    QVERIFY(expected.contains("<source>Pong</source>"));
+
+    for (int run = 0; run < 10; ++run) {
+        const QString tsFile = QStringLiteral("parallel%1.ts").arg(run);
+        QVERIFY2(runLupdate(dir, arguments(8, tsFile), &output), qPrintable(output));
+        QCOMPARE(diagnostics(output), expectedDiagnostics);
+        QFile parallel(outDir.filePath(tsFile));
+        QVERIFY(parallel.open(QIODevice::ReadOnly));
+        QCOMPARE(parallel.readAll(), expected);
+    }
+}
+
+// A run using the extraction cache must give what a run without it does, and
+// notice a header shadowing the one found before.
+void tst_lupdate::extractionCache()
+{
+    const QString dataDir = m_basePath + QLatin1String("extractioncache/");
+    QTemporaryDir workDir;
+    QVERIFY(workDir.isValid());
+    const QDir dir(workDir.path());
+    QVERIFY(dir.mkdir(QLatin1String("first")));
+    QVERIFY(dir.mkdir(QLatin1String("second")));
+    const QStringList sources = { QLatin1String("main.cpp"), QLatin1String("direct.h"),
+                                  QLatin1String("indirect.h") };
+    for (const QString &source : sources)
+        QVERIFY(QFile::copy(dataDir + source, dir.filePath(source)));
+    QVERIFY(QFile::copy(dataDir + QLatin1String("shadowed.h"),
+                        dir.filePath(QLatin1String("second/shadowed.h"))));
+
+    const QString cacheFile = dir.filePath(QLatin1String("project.cache"));
+    const auto run = [&](const QString &tsFile, QByteArray *contents) {
+        QString output;
+        const QStringList arguments = { QLatin1String("-silent"), QLatin1String("main.cpp"),
+                                        QLatin1String("-Ifirst"), QLatin1String("-Isecond"),
+                                        QLatin1String("-extraction-cache"), cacheFile,
+                                        QLatin1String("-ts"), tsFile };
+        if (!runLupdate(workDir.path(), arguments, &output)) {
+            qWarning("%s", qPrintable(output));
+            return false;
+        }
+        QFile ts(dir.filePath(tsFile));
+        if (!ts.open(QIODevice::ReadOnly))
+            return false;
+        *contents = ts.readAll();
+        return true;
+    };
+
+    QByteArray cold;
+    QVERIFY(run(QLatin1String("cold.ts"), &cold));
+    QVERIFY(cold.contains("<source>main text</source>"));
+    QVERIFY(cold.contains("<source>direct text</source>"));
+    QVERIFY(cold.contains("<source>second text</source>"));
+    QVERIFY(!cold.contains("<source>indirect text</source>"));
+    QVERIFY(QFileInfo::exists(cacheFile));
+
+    // The cache is only written when an entry was added, so an unchanged
+    // modification time shows that the second run took everything from it.
+    const QDateTime stamp =
+            QDateTime::fromSecsSinceEpoch(QDateTime::currentSecsSinceEpoch() - 86400);
+    {
+        QFile cache(cacheFile);
+        QVERIFY(cache.open(QIODevice::ReadWrite));
+        QVERIFY(cache.setFileTime(stamp, QFileDevice::FileModificationTime));
+    }
+    QByteArray warm;
+    QVERIFY(run(QLatin1String("warm.ts"), &warm));
+    QCOMPARE(QFileInfo(cacheFile).lastModified(), stamp);
+    QCOMPARE(warm, cold);
+
+    QFile shadowing(dir.filePath(QLatin1String("first/shadowed.h")));
+    QVERIFY(shadowing.open(QIODevice::WriteOnly));
+    shadowing.write("const char *shadowingText = QT_TRANSLATE_NOOP(\"shadowed\", \"first text\");\n");
+    shadowing.close();
+    QByteArray shadowed;
+    QVERIFY(run(QLatin1String("shadowed.ts"), &shadowed));
+    QVERIFY(shadowed.contains("<source>first text</source>"));
+    QVERIFY(!shadowed.contains("<source>second text</source>"));
+}
+
+// Files included by other input files are left out on warm runs as on cold
+// ones, also when they were only included by a file left out itself.
+void tst_lupdate::extractionCacheBlacklisting()
+{
+    const QString dir = m_basePath + QLatin1String("extractioncache/transitive");
+    QTemporaryDir outDir;
+    QVERIFY(outDir.isValid());
+    const QString cacheFile = outDir.filePath(QLatin1String("project.cache"));
+
+    const auto run = [&](const QString &tsFile, bool useCache, QByteArray *contents) {
+        QStringList arguments = { QLatin1String("-silent"), QLatin1String("a.cpp"),
+                                  QLatin1String("b.h"), QLatin1String("c.h") };
+        if (useCache)
+            arguments << QLatin1String("-extraction-cache") << cacheFile;
+        arguments << QLatin1String("-ts") << outDir.filePath(tsFile);
+        QString output;
+        if (!runLupdate(dir, arguments, &output)) {
+            qWarning("%s", qPrintable(output));
+            return false;
+        }
+        QFile ts(outDir.filePath(tsFile));
+        if (!ts.open(QIODevice::ReadOnly))
+            return false;
+        *contents = ts.readAll();
+        return true;
+    };
+
+    QByteArray uncached;
+    QVERIFY(run(QLatin1String("uncached.ts"), false, &uncached));
+    QVERIFY(uncached.contains("<source>c text</source>"));
+    QByteArray cold;
+    QVERIFY(run(QLatin1String("cold.ts"), true, &cold));
+    QCOMPARE(cold, uncached);
+    QByteArray warm;
+    QVERIFY(run(QLatin1String("warm.ts"), true, &warm));
+    QCOMPARE(warm, cold);
+}
+
 #if CHECK_SIMTEXTH
 void tst_lupdate::simtexth()
 {
@@ -0,0 +1,94 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+#include <QtTest/QtTest>
+
+#include "../../../src/assistant/help/qhelpsearchtextextractor_p.h"
+
+using fulltextsearch::qt::TextExtractor;
+
+class tst_QHelpSearchTextExtractor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void title_data();
+    void title();
+    void text_data();
+    void text();
+};
+
+void tst_QHelpSearchTextExtractor::title_data()
+{
+    QTest::addColumn<QString>("html");
+    QTest::addColumn<QString>("title");
+
+    QTest::newRow("none") << "<html><body><p>Text</p></body></html>" << "";
+    QTest::newRow("head")
+            << "<html><head><meta charset=\"utf-8\"><title>QString Class</title></head></html>"
+            << "QString Class";
+    QTest::newRow("case") << "<TITLE>Upper</Title>" << "Upper";
+    QTest::newRow("white space") << "<title>\n  Signals &amp;\n  Slots </title>"
+                                 << "Signals & Slots";
+    QTest::newRow("markup") << "<title>a <b> c</title>" << "a <b> c";
+    QTest::newRow("first") << "<title>One</title><title>Two</title>" << "One";
+    QTest::newRow("unclosed") << "<title>Open" << "Open";
+}
+
+void tst_QHelpSearchTextExtractor::title()
+{
+    QFETCH(QString, html);
+    QFETCH(QString, title);
+
+    QCOMPARE(TextExtractor(html).title(), title);
+}
+
+void tst_QHelpSearchTextExtractor::text_data()
+{
+    QTest::addColumn<QString>("html");
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("empty") << "" << "";
+    QTest::newRow("plain") << "Just text" << "Just text";
+    QTest::newRow("inline") << "<p>A <b>bold</b> <a href=\"x.html\">link</a>.</p>"
+                            << "A bold link.";
+    QTest::newRow("white space") << "<p>  many \t\n spaces  </p>" << "many spaces";
+    QTest::newRow("blocks") << "<h1>Title</h1><p>One</p><div>Two</div><ul><li>a</li><li>b</li></ul>"
+                            << "Title\nOne\nTwo\na\nb";
+    QTest::newRow("table") << "<table><tr><td>a</td><td>b</td></tr></table>" << "a\nb";
+    QTest::newRow("br") << "one<br>two<br/><br>three" << "one\ntwo\n\nthree";
+    QTest::newRow("pre") << "<p>x</p><pre>int  a;\n  b();</pre><p>y   z</p>"
+                         << "x\nint  a;\n  b();\ny z";
+    QTest::newRow("head") << "<html><head><title>T</title><meta name=\"a\" content=\"b\">"
+                             "<link rel=\"stylesheet\" href=\"s.css\"></head>"
+                             "<body>Body</body></html>"
+                          << "Body";
+    QTest::newRow("script") << "a<script type=\"text/javascript\">if (a < b) x = \"</p>\";"
+                               "</SCRIPT>b"
+                            << "ab";
+    QTest::newRow("style") << "a<style>p { color: red }</style>b" << "ab";
+    QTest::newRow("comment") << "a<!-- <p>hidden</p> -->b" << "ab";
+    QTest::newRow("doctype") << "<!DOCTYPE html><?xml version=\"1.0\"?>text" << "text";
+    QTest::newRow("named entities") << "&lt;QString&gt; &amp;&quot;&copy;&mdash;"
+                                    << QString::fromUtf16(u"<QString> &\"\u00A9\u2014");
+    QTest::newRow("numeric entities") << "&#65;&#x42;&#X43;&#68" << "ABCD";
+    QTest::newRow("supplementary") << "&#x1F600;" << QString::fromUtf16(u"\U0001F600");
+    QTest::newRow("invalid entities") << "&#0; &#xD800; &#x110000;"
+                                      << QString::fromUtf16(u"\uFFFD \uFFFD \uFFFD");
+    QTest::newRow("unknown entities") << "&foo; &amp &" << "&foo; &amp &";
+    QTest::newRow("nbsp") << "a&nbsp;&nbsp;b" << "a  b";
+    QTest::newRow("less than") << "a < b <3" << "a < b <3";
+    QTest::newRow("attributes") << "<a title=\"x > y\" alt='>'>z</a>" << "z";
+    QTest::newRow("apostrophe") << "<a title=don't>z</a>" << "z";
+}
+
+void tst_QHelpSearchTextExtractor::text()
+{
+    QFETCH(QString, html);
+    QFETCH(QString, text);
+
+    QCOMPARE(TextExtractor(html).text(), text);
+}
+
+QTEST_APPLESS_MAIN(tst_QHelpSearchTextExtractor)
+
+#include "tst_qhelpsearchtextextractor.moc"
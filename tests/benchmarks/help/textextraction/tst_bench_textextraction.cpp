@@ -0,0 +1,172 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtHelp/private/qhelpdbreader_p.h>
+#include <QtHelp/private/qhelpsearchtextextractor_p.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QLibraryInfo>
+#include <QtCore/QStringDecoder>
+#include <QtCore/QTextStream>
+#include <QtGui/QTextDocument>
+#include <QtTest/QtTest>
+
+using fulltextsearch::qt::TextExtractor;
+
+/*
+  Getting the title and the text of the pages to index, with the help
+  search's own extractor and with QTextDocument, which it replaced. The
+  pages come from the Qt documentation installed with Qt, or from the
+  directory of .qch files in QT_HELP_BENCHMARK_DOCS; a generated page is
+  used when there is neither.
+*/
+class tst_bench_textextraction : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void textExtractor_data();
+    void textExtractor();
+    void textDocument_data();
+    void textDocument();
+
+private:
+    void addRows();
+
+    QMap<QString, QStringList> m_pages;
+};
+
+enum { MaxPagesPerFile = 500 };
+
+// The HTML pages of a compressed help file, decoded as the indexer does.
+static QStringList readPages(const QString &fileName)
+{
+    QStringList pages;
+    QHelpDBReader reader(fileName);
+    if (!reader.init())
+        return pages;
+
+    reader.readCompressedFiles({}, { QLatin1String("html") },
+                               [&pages](const QString &, const QByteArray &compressed) {
+        const QByteArray data = qUncompress(compressed);
+        QTextStream s(data);
+        auto encoding = QStringDecoder::encodingForHtml(data);
+        if (encoding)
+            s.setEncoding(*encoding);
+        pages.append(s.readAll());
+        return pages.size() < MaxPagesPerFile;
+    });
+    return pages;
+}
+
+// A class reference page much like the ones QDoc writes.
+static QString generatedPage()
+{
+    QString page = QLatin1String(
+            "<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n"
+            "  <meta charset=\"utf-8\">\n"
+            "  <title>QGenerated Class | Qt Core 6.4</title>\n"
+            "  <link rel=\"stylesheet\" type=\"text/css\" href=\"style/offline.css\" />\n"
+            "  <script type=\"text/javascript\">document.documentElement.className = "
+            "\"js\"; if (a < b && c > d) {}</script>\n"
+            "</head>\n<body>\n<div class=\"sidebar\"><ul><li><a href=\"#details\">"
+            "Detailed Description</a></li></ul></div>\n"
+            "<h1 class=\"title\">QGenerated Class</h1>\n"
+            "<p>The QGenerated class is generated for the benchmarks. "
+            "<a href=\"#details\">More...</a></p>\n"
+            "<table class=\"alignedsummary\"><tr><td class=\"memItemLeft\">Header:</td>"
+            "<td class=\"memItemRight\"><span class=\"preprocessor\">#include "
+            "&lt;QGenerated&gt;</span></td></tr></table>\n");
+    for (int i = 0; i < 100; ++i) {
+        const QString n = QString::number(i);
+        page += QLatin1String("<h3 class=\"fn\" id=\"member") + n
+                + QLatin1String("\"><a name=\"member") + n
+                + QLatin1String("\"></a><span class=\"type\">bool</span> QGenerated::"
+                                "<span class=\"name\">member") + n
+                + QLatin1String("</span>(const <span class=\"type\"><a href=\"qstring.html\">"
+                                "QString</a></span> &amp;<i>text</i>) const</h3>\n"
+                                "<p>Returns <code>true</code> if <i>text</i> matches entry ")
+                + n
+                + QLatin1String("&nbsp;of the list; otherwise returns <code>false</code>."
+                                "</p>\n<pre class=\"cpp\">  <span class=\"keyword\">if</span> "
+                                "(g.member") + n
+                + QLatin1String("(<span class=\"string\">&quot;text&quot;</span>))\n"
+                                "      ok();</pre>\n<p><b>See also </b><a href=\"#member")
+                + n + QLatin1String("\">member</a>() &mdash; and the overview.</p>\n");
+    }
+    page += QLatin1String("</body>\n</html>\n");
+    return page;
+}
+
+void tst_bench_textextraction::initTestCase()
+{
+    QString docsPath = qEnvironmentVariable("QT_HELP_BENCHMARK_DOCS");
+    if (docsPath.isEmpty())
+        docsPath = QLibraryInfo::path(QLibraryInfo::DocumentationPath);
+
+    const QDir docs(docsPath);
+    const QStringList files = { QLatin1String("qtcore.qch"), QLatin1String("qtgui.qch"),
+                                QLatin1String("qtwidgets.qch"), QLatin1String("qtdoc.qch") };
+    for (const QString &file : files) {
+        if (!docs.exists(file))
+            continue;
+        const QStringList pages = readPages(docs.filePath(file));
+        if (!pages.isEmpty())
+            m_pages.insert(file, pages);
+    }
+    if (m_pages.isEmpty())
+        m_pages.insert(QLatin1String("generated"), QStringList(generatedPage()));
+}
+
+void tst_bench_textextraction::addRows()
+{
+    QTest::addColumn<QStringList>("pages");
+
+    for (auto it = m_pages.cbegin(), end = m_pages.cend(); it != end; ++it)
+        QTest::newRow(qPrintable(it.key())) << it.value();
+}
+
+void tst_bench_textextraction::textExtractor_data()
+{
+    addRows();
+}
+
+void tst_bench_textextraction::textExtractor()
+{
+    QFETCH(QStringList, pages);
+
+    qsizetype length = 0;
+    QBENCHMARK {
+        for (const QString &page : pages) {
+            const TextExtractor extractor(page);
+            length += extractor.title().size() + extractor.text().size();
+        }
+    }
+    QVERIFY(length > 0);
+}
+
+void tst_bench_textextraction::textDocument_data()
+{
+    addRows();
+}
+
+void tst_bench_textextraction::textDocument()
+{
+    QFETCH(QStringList, pages);
+
+    qsizetype length = 0;
+    QBENCHMARK {
+        for (const QString &page : pages) {
+            QTextDocument doc;
+            doc.setHtml(page);
+            length += doc.metaInformation(QTextDocument::DocumentTitle).size()
+                    + doc.toPlainText().size();
+        }
+    }
+    QVERIFY(length > 0);
+}
+
+QTEST_MAIN(tst_bench_textextraction)
+
+#include "tst_bench_textextraction.moc"
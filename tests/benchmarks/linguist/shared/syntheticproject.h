@@ -0,0 +1,151 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef SYNTHETICPROJECT_H
+#define SYNTHETICPROJECT_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+/*
+  A generated project for the linguist benchmarks: source files with a few
+  contexts each, each context with a fixed set of messages.
+
+  Revision 1 is revision 0 after a round of typical edits, made so that
+  merging the translations of revision 0 into it exercises all of merge()'s
+  heuristics:
+  - every message moves down a line,
+  - some texts get a different number (number heuristic),
+  - some texts get reworded slightly (similar text heuristic),
+  - some messages are removed, and each context gets a new one,
+  - each file gets a new context reusing a text which is translated
+    everywhere else (same text heuristic).
+*/
+namespace SyntheticProject {
+
+enum {
+    ContextsPerFile = 5,
+    MessagesPerContext = 20
+};
+
+struct Language
+{
+    const char *code;
+    int numerusForms;
+};
+
+static const Language languages[] = { { "de", 2 }, { "pl", 3 }, { "ja", 1 } };
+
+struct Message
+{
+    QString context;
+    QString source;
+    QString fileName;
+    int line;
+    bool plural;
+};
+
+// Letters only, so that the number heuristic does not see the ids.
+inline QString letterId(int n)
+{
+    QString id;
+    do {
+        id.prepend(QChar(char16_t(u'a' + n % 26)));
+        n /= 26;
+    } while (n);
+    return id;
+}
+
+inline QString fileName(int file)
+{
+    return QLatin1String("file") + QString::number(file) + QLatin1String(".cpp");
+}
+
+// The text of a message, or an empty string if it does not exist in the revision.
+// The id tells the messages apart.
+inline QString messageText(int message, const QString &id, int revision, bool *plural)
+{
+    *plural = false;
+    switch (message % 10) {
+    case 0:
+        *plural = true;
+        return QLatin1String("Removed %n entries from list ") + id;
+    case 1:
+        return QLatin1String("Page ") + QString::number(3 + revision)
+                + QLatin1String(" of 12 in ") + id;
+    case 2:
+        return revision ? QLatin1String("Could not open file ") + id + QLatin1Char('.')
+                        : QLatin1String("Could not open the file ") + id;
+    case 3:
+        return revision ? QString() : QLatin1String("Discard the changes to ") + id + QLatin1Char('?');
+    case 4:
+        if (message == 4)
+            return QLatin1String("Cancel");
+        Q_FALLTHROUGH();
+    default:
+        return QLatin1String("Show the details of ") + id;
+    }
+}
+
+// Generates the source of one file, and the messages lupdate extracts from it.
+inline QByteArray fileSource(int file, int revision, QList<Message> *messages)
+{
+    QStringList lines;
+    lines << QLatin1String("// Generated by the linguist benchmarks")
+          << QString()
+          << QLatin1String("#include <QtCore/QCoreApplication>");
+
+    auto addMessage = [&](const QString &context, const QString &text, bool plural) {
+        lines << (QLatin1String("    QCoreApplication::translate(\"") + context
+                  + QLatin1String("\", \"") + text
+                  + (plural ? QLatin1String("\", nullptr, n);") : QLatin1String("\");")));
+        messages->append({ context, text, fileName(file), int(lines.size()), plural });
+    };
+
+    const int contexts = ContextsPerFile + (revision ? 1 : 0);
+    for (int c = 0; c < contexts; ++c) {
+        const QString id = letterId(file * (ContextsPerFile + 1) + c);
+        const QString context = QLatin1String("Dialog_") + id;
+        lines << QString()
+              << QLatin1String("void texts_") + id + QLatin1String("(int n)")
+              << QLatin1String("{");
+        if (revision)
+            lines << QLatin1String("    // Revision ") + QString::number(revision);
+        if (c == ContextsPerFile) {
+            addMessage(context, QLatin1String("Cancel"), false);
+        } else {
+            for (int m = 0; m < MessagesPerContext; ++m) {
+                bool plural;
+                const QString text = messageText(
+                        m, id + QLatin1Char('_') + letterId(m), revision, &plural);
+                if (!text.isEmpty())
+                    addMessage(context, text, plural);
+            }
+            if (revision)
+                addMessage(context, QLatin1String("Reset ") + id, false);
+        }
+        lines << QLatin1String("    (void)n;")
+              << QLatin1String("}");
+    }
+    lines << QString();
+    return lines.join(QLatin1Char('\n')).toUtf8();
+}
+
+// The translation of a message; its numerus forms for plural messages.
+inline QStringList translations(const Message &message, const Language &language)
+{
+    const QString prefix = QLatin1Char('[') + QString::fromLatin1(language.code);
+    if (!message.plural)
+        return { prefix + QLatin1String("] ") + message.source };
+    QStringList forms;
+    for (int i = 0; i < language.numerusForms; ++i)
+        forms << prefix + QLatin1Char(' ') + QString::number(i) + QLatin1String("] ")
+                        + message.source;
+    return forms;
+}
+
+} // namespace SyntheticProject
+
+#endif // SYNTHETICPROJECT_H
@@ -0,0 +1,357 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "../shared/syntheticproject.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QLibraryInfo>
+#include <QtCore/QProcess>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+#include <QtTools/private/qttools-config_p.h>
+
+#include <iterator>
+
+#ifdef Q_OS_UNIX
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <sys/resource.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+
+using namespace SyntheticProject;
+
+/*
+  lupdate, lrelease and lconvert on generated projects. Each tool runs once
+  per data row; besides the time, the messages per second and the peak
+  memory use of the tool are printed.
+*/
+class tst_bench_linguisttools : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_bench_linguisttools();
+
+private slots:
+    void lupdate_data();
+    void lupdate();
+    void lupdateMerge_data();
+    void lupdateMerge();
+    void lrelease_data();
+    void lrelease();
+    void lconvert_data();
+    void lconvert();
+
+private:
+    void runBenchmark(const QString &program, const QStringList &arguments,
+                      const QString &workingDirectory, int messages);
+    void lupdateProject(bool existingTranslations);
+
+    QString m_binPath;
+};
+
+tst_bench_linguisttools::tst_bench_linguisttools()
+    : m_binPath(QLibraryInfo::path(QLibraryInfo::BinariesPath) + QLatin1Char('/'))
+{
+}
+
+struct ToolRun
+{
+    qint64 milliseconds = 0;
+    long peakMemoryKiB = -1; // unknown
+};
+
+static bool runTool(const QString &program, const QStringList &arguments,
+                    const QString &workingDirectory, ToolRun *run, QString *errorString)
+{
+    QElapsedTimer timer;
+#ifdef Q_OS_UNIX
+    // Not QProcess: wait4() gives the resource usage of the tool alone.
+    const QByteArray path = QFile::encodeName(program);
+    const QByteArray directory = QFile::encodeName(workingDirectory);
+    QList<QByteArray> encodedArguments = { path };
+    for (const QString &argument : arguments)
+        encodedArguments << argument.toLocal8Bit();
+    QList<char *> argv;
+    for (QByteArray &argument : encodedArguments)
+        argv << argument.data();
+    argv << nullptr;
+
+    timer.start();
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        const int devNull = ::open("/dev/null", O_WRONLY);
+        if (devNull >= 0 && ::dup2(devNull, STDOUT_FILENO) >= 0
+                && ::chdir(directory.constData()) == 0) {
+            ::execv(path.constData(), argv.data());
+        }
+        ::_exit(127);
+    }
+    int status = 0;
+    struct rusage usage;
+    pid_t waited = -1;
+    if (pid > 0) {
+        do {
+            waited = ::wait4(pid, &status, 0, &usage);
+        } while (waited < 0 && errno == EINTR);
+    }
+    if (waited != pid) {
+        *errorString = qt_error_string(errno);
+        return false;
+    }
+    run->milliseconds = timer.elapsed();
+#  ifdef Q_OS_DARWIN
+    run->peakMemoryKiB = usage.ru_maxrss / 1024;
+#  else
+    run->peakMemoryKiB = usage.ru_maxrss;
+#  endif
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        *errorString = QStringLiteral("%1 failed with status %2").arg(program).arg(status);
+        return false;
+    }
+#else
+    QProcess proc;
+    proc.setWorkingDirectory(workingDirectory);
+    proc.setStandardOutputFile(QProcess::nullDevice());
+    proc.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    timer.start();
+    proc.start(program, arguments);
+    if (!proc.waitForFinished(-1)) {
+        *errorString = proc.errorString();
+        return false;
+    }
+    run->milliseconds = timer.elapsed();
+    if (proc.exitStatus() != QProcess::NormalExit || proc.exitCode() != 0) {
+        *errorString = QStringLiteral("%1 exited with code %2").arg(program).arg(proc.exitCode());
+        return false;
+    }
+#endif
+    return true;
+}
+
+static bool writeFile(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly) && file.write(contents) == contents.size();
+}
+
+static QString tsFileName(const Language &language)
+{
+    return QLatin1String("app_") + QLatin1String(language.code) + QLatin1String(".ts");
+}
+
+// Writes the sources of the revision and a project file listing them and the
+// TS files of all languages. Returns the messages of the sources.
+static QList<Message> writeProject(const QDir &dir, int files, int revision)
+{
+    QList<Message> messages;
+    QByteArray project = "QT = core\n";
+    for (int file = 0; file < files; ++file) {
+        const QString name = fileName(file);
+        if (!writeFile(dir.filePath(name), fileSource(file, revision, &messages)))
+            return {};
+        project += "SOURCES += " + name.toUtf8() + '\n';
+    }
+    for (const Language &language : languages)
+        project += "TRANSLATIONS += " + tsFileName(language).toUtf8() + '\n';
+    if (!writeFile(dir.filePath(QLatin1String("project.pro")), project)
+            || !writeFile(dir.filePath(QLatin1String(".qmake.cache")), QByteArray())) {
+        return {};
+    }
+    return messages;
+}
+
+// A TS file with finished translations of the messages.
+static QByteArray tsFile(const QList<Message> &messages, const Language &language)
+{
+    QByteArray ts = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+                    "<!DOCTYPE TS>\n"
+                    "<TS version=\"2.1\" language=\"" + QByteArray(language.code) + "\">\n";
+    QString context;
+    for (const Message &message : messages) {
+        if (message.context != context) {
+            if (!context.isEmpty())
+                ts += "</context>\n";
+            context = message.context;
+            ts += "<context>\n    <name>" + context.toUtf8() + "</name>\n";
+        }
+        ts += message.plural ? "    <message numerus=\"yes\">\n" : "    <message>\n";
+        ts += "        <location filename=\"" + message.fileName.toUtf8()
+                + "\" line=\"" + QByteArray::number(message.line) + "\"/>\n"
+              "        <source>" + message.source.toUtf8() + "</source>\n";
+        const QStringList forms = translations(message, language);
+        if (message.plural) {
+            ts += "        <translation>\n";
+            for (const QString &form : forms)
+                ts += "            <numerusform>" + form.toUtf8() + "</numerusform>\n";
+            ts += "        </translation>\n";
+        } else {
+            ts += "        <translation>" + forms.first().toUtf8() + "</translation>\n";
+        }
+        ts += "    </message>\n";
+    }
+    if (!context.isEmpty())
+        ts += "</context>\n";
+    ts += "</TS>\n";
+    return ts;
+}
+
+static void addSizeRows()
+{
+    QTest::addColumn<int>("files");
+
+    for (int files : { 10, 100, 1000 })
+        QTest::addRow("%d messages", files * ContextsPerFile * MessagesPerContext) << files;
+}
+
+void tst_bench_linguisttools::runBenchmark(const QString &program, const QStringList &arguments,
+                                           const QString &workingDirectory, int messages)
+{
+    ToolRun run;
+    QString errorString;
+    QBENCHMARK_ONCE {
+        QVERIFY2(runTool(program, arguments, workingDirectory, &run, &errorString),
+                 qPrintable(errorString));
+    }
+    const double perSecond = run.milliseconds ? messages * 1000.0 / run.milliseconds : 0;
+    if (run.peakMemoryKiB >= 0) {
+        qInfo("%d messages, %.0f messages/s, peak memory %ld KiB",
+              messages, perSecond, run.peakMemoryKiB);
+    } else {
+        qInfo("%d messages, %.0f messages/s", messages, perSecond);
+    }
+}
+
+void tst_bench_linguisttools::lupdate_data()
+{
+    QTest::addColumn<int>("files");
+    QTest::addColumn<bool>("clangParser");
+
+    for (int files : { 10, 100, 1000 }) {
+        QTest::addRow("built-in parser, %d messages",
+                      files * ContextsPerFile * MessagesPerContext) << files << false;
+    }
+#if QT_CONFIG(clangcpp)
+    for (int files : { 10, 100 }) {
+        QTest::addRow("clang parser, %d messages",
+                      files * ContextsPerFile * MessagesPerContext) << files << true;
+    }
+#endif
+}
+
+void tst_bench_linguisttools::lupdate()
+{
+    lupdateProject(false);
+}
+
+void tst_bench_linguisttools::lupdateMerge_data()
+{
+    lupdate_data();
+}
+
+// Updates translated TS files to the next revision of the sources, which
+// is where merge() and its heuristics kick in.
+void tst_bench_linguisttools::lupdateMerge()
+{
+    lupdateProject(true);
+}
+
+void tst_bench_linguisttools::lupdateProject(bool existingTranslations)
+{
+    QFETCH(int, files);
+    QFETCH(bool, clangParser);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    if (existingTranslations) {
+        const QList<Message> messages = writeProject(QDir(dir.path()), files, 0);
+        QVERIFY(!messages.isEmpty());
+        for (const Language &language : languages)
+            QVERIFY(writeFile(dir.filePath(tsFileName(language)), tsFile(messages, language)));
+    }
+    const QList<Message> messages = writeProject(QDir(dir.path()), files, 1);
+    QVERIFY(!messages.isEmpty());
+
+    QStringList arguments = { QLatin1String("-silent"), QLatin1String("project.pro") };
+    if (clangParser)
+        arguments << QLatin1String("-clang-parser");
+    runBenchmark(m_binPath + QLatin1String("lupdate"), arguments, dir.path(),
+                 messages.size() * int(std::size(languages)));
+}
+
+void tst_bench_linguisttools::lrelease_data()
+{
+    addSizeRows();
+}
+
+void tst_bench_linguisttools::lrelease()
+{
+    QFETCH(int, files);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QList<Message> messages = writeProject(QDir(dir.path()), files, 0);
+    QVERIFY(!messages.isEmpty());
+    QStringList arguments = { QLatin1String("-silent") };
+    for (const Language &language : languages) {
+        QVERIFY(writeFile(dir.filePath(tsFileName(language)), tsFile(messages, language)));
+        arguments << tsFileName(language);
+    }
+    runBenchmark(m_binPath + QLatin1String("lrelease"), arguments, dir.path(),
+                 messages.size() * int(std::size(languages)));
+}
+
+void tst_bench_linguisttools::lconvert_data()
+{
+    QTest::addColumn<QString>("from");
+    QTest::addColumn<QString>("to");
+    QTest::addColumn<int>("files");
+
+    static const char *const conversions[][2] = {
+        { "ts", "po" }, { "po", "ts" }, { "ts", "xlf" }, { "xlf", "ts" }, { "ts", "qm" }
+    };
+    for (const auto &conversion : conversions) {
+        for (int files : { 10, 100, 1000 }) {
+            QTest::addRow("%s to %s, %d messages", conversion[0], conversion[1],
+                          files * ContextsPerFile * MessagesPerContext)
+                    << QString::fromLatin1(conversion[0]) << QString::fromLatin1(conversion[1])
+                    << files;
+        }
+    }
+}
+
+void tst_bench_linguisttools::lconvert()
+{
+    QFETCH(QString, from);
+    QFETCH(QString, to);
+    QFETCH(int, files);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QList<Message> messages;
+    for (int file = 0; file < files; ++file)
+        fileSource(file, 0, &messages);
+    QVERIFY(writeFile(dir.filePath(QLatin1String("in.ts")), tsFile(messages, languages[0])));
+
+    const QString lconvert = m_binPath + QLatin1String("lconvert");
+    const QString input = QLatin1String("in.") + from;
+    if (from != QLatin1String("ts")) {
+        ToolRun run;
+        QString errorString;
+        QVERIFY2(runTool(lconvert, { QLatin1String("-i"), QLatin1String("in.ts"),
+                                     QLatin1String("-o"), input },
+                         dir.path(), &run, &errorString),
+                 qPrintable(errorString));
+    }
+    runBenchmark(lconvert, { QLatin1String("-i"), input,
+                             QLatin1String("-o"), QLatin1String("out.") + to },
+                 dir.path(), messages.size());
+}
+
+QTEST_GUILESS_MAIN(tst_bench_linguisttools)
+
+#include "tst_bench_linguisttools.moc"
@@ -0,0 +1,167 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "../shared/syntheticproject.h"
+
+#include "lupdate.h"
+#include "translator.h"
+
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+using namespace SyntheticProject;
+
+/*
+  The in-process parts of the translation toolchain: the catalog formats,
+  lupdate's merge() and the sorted insertion it uses. The data tags give the
+  number of messages, which turns the time per iteration into throughput.
+*/
+class tst_bench_translator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void save_data();
+    void save();
+    void load_data();
+    void load();
+    void merge_data();
+    void merge();
+    void appendSorted_data();
+    void appendSorted();
+
+private:
+    QTemporaryDir m_dir;
+};
+
+// A catalog of the messages of the project; translated if there is a language
+static Translator makeTranslator(int files, int revision, const Language *language)
+{
+    Translator tor;
+    tor.setLanguageCode(QString::fromLatin1(language ? language->code : "de"));
+    tor.setSourceLanguageCode(QLatin1String("en"));
+    for (int file = 0; file < files; ++file) {
+        QList<Message> messages;
+        fileSource(file, revision, &messages);
+        for (const Message &m : qAsConst(messages)) {
+            tor.append(TranslatorMessage(
+                    m.context, m.source, QString(), QString(), m.fileName, m.line,
+                    language ? translations(m, *language) : QStringList(),
+                    language ? TranslatorMessage::Finished : TranslatorMessage::Unfinished,
+                    m.plural));
+        }
+    }
+    return tor;
+}
+
+static void addFormatRows()
+{
+    QTest::addColumn<QString>("format");
+    QTest::addColumn<int>("files");
+
+    for (const char *format : { "ts", "po", "xlf", "qm" }) {
+        for (int files : { 10, 100, 1000 }) {
+            QTest::addRow("%s, %d messages", format,
+                          files * ContextsPerFile * MessagesPerContext)
+                    << QString::fromLatin1(format) << files;
+        }
+    }
+}
+
+void tst_bench_translator::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+void tst_bench_translator::save_data()
+{
+    addFormatRows();
+}
+
+void tst_bench_translator::save()
+{
+    QFETCH(QString, format);
+    QFETCH(int, files);
+
+    const Translator tor = makeTranslator(files, 0, &languages[0]);
+    const QString fileName = m_dir.filePath(QLatin1String("save.") + format);
+    QBENCHMARK {
+        ConversionData cd;
+        QVERIFY2(tor.save(fileName, cd, format), qPrintable(cd.error()));
+    }
+}
+
+void tst_bench_translator::load_data()
+{
+    addFormatRows();
+}
+
+void tst_bench_translator::load()
+{
+    QFETCH(QString, format);
+    QFETCH(int, files);
+
+    const QString fileName = m_dir.filePath(QLatin1String("load.") + format);
+    ConversionData cd;
+    QVERIFY2(makeTranslator(files, 0, &languages[0]).save(fileName, cd, format),
+             qPrintable(cd.error()));
+    QBENCHMARK {
+        Translator tor;
+        QVERIFY2(tor.load(fileName, cd, format), qPrintable(cd.error()));
+    }
+}
+
+void tst_bench_translator::merge_data()
+{
+    QTest::addColumn<int>("files");
+
+    for (int files : { 10, 100, 1000 })
+        QTest::addRow("%d messages", files * ContextsPerFile * MessagesPerContext) << files;
+}
+
+void tst_bench_translator::merge()
+{
+    QFETCH(int, files);
+
+    const Translator tor = makeTranslator(files, 0, &languages[0]);
+    const Translator virginTor = makeTranslator(files, 1, nullptr);
+    const UpdateOptions options = HeuristicSameText | HeuristicSimilarText | HeuristicNumber;
+    QBENCHMARK {
+        QString err;
+        const Translator merged = QT_PREPEND_NAMESPACE(merge)(tor, virginTor, {}, options, err);
+        QVERIFY(merged.messageCount() > virginTor.messageCount());
+    }
+}
+
+void tst_bench_translator::appendSorted_data()
+{
+    QTest::addColumn<int>("files");
+
+    for (int files : { 10, 100, 1000 })
+        QTest::addRow("%d messages", files * ContextsPerFile * MessagesPerContext) << files;
+}
+
+// Every tenth message gets a new neighbor in the middle of its context.
+void tst_bench_translator::appendSorted()
+{
+    QFETCH(int, files);
+
+    const Translator tor = makeTranslator(files, 0, nullptr);
+    QList<TranslatorMessage> added;
+    for (int i = 0; i < tor.messageCount(); i += 10) {
+        const TranslatorMessage &msg = tor.constMessage(i);
+        added.append(TranslatorMessage(msg.context(), QLatin1String("New ") + msg.sourceText(),
+                                       QString(), QString(), msg.fileName(), msg.lineNumber(),
+                                       QStringList(), TranslatorMessage::Unfinished, false));
+    }
+    QBENCHMARK {
+        Translator sorted = tor;
+        sorted.appendSorted(added);
+        QCOMPARE(sorted.messageCount(), tor.messageCount() + added.size());
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_bench_translator)
+
+#include "tst_bench_translator.moc"